@@ -1098,6 +1098,27 @@ typedef enum {
      * Since: 8.5.0
      */
     VIR_MIGRATE_ZEROCOPY = (1 << 20),
+
+    /* Let the hypervisor driver watch the progress of the migration and tune
+     * it automatically when the guest dirties memory faster than it can be
+     * transferred. For QEMU/KVM this means the allowed downtime is raised
+     * when the remaining memory could be transferred within a reasonable
+     * time and, if VIR_MIGRATE_POSTCOPY is used as well, the migration is
+     * switched to post-copy when it still does not converge.
+     *
+     * Since: 9.2.0
+     */
+    VIR_MIGRATE_AUTO_TUNE = (1 << 21),
+
+    /* Transfer pages requested by the destination during post-copy migration
+     * over a dedicated connection so that they do not have to wait behind
+     * pages which are being sent in the background. This reduces the time
+     * the guest is blocked on page faults after switching to post-copy. Only
+     * usable together with VIR_MIGRATE_POSTCOPY.
+     *
+     * Since: 9.2.0
+     */
+    VIR_MIGRATE_POSTCOPY_PREEMPT = (1 << 22),
 } virDomainMigrateFlags;
 
 
@@ -1570,6 +1591,7 @@ typedef enum {
     VIR_DOMAIN_SAVE_RUNNING      = 1 << 1, /* Favor running over paused (Since: 0.9.5) */
     VIR_DOMAIN_SAVE_PAUSED       = 1 << 2, /* Favor paused over running (Since: 0.9.5) */
     VIR_DOMAIN_SAVE_RESET_NVRAM  = 1 << 3, /* Re-initialize NVRAM from template (Since: 8.1.0) */
+    VIR_DOMAIN_SAVE_PARALLEL     = 1 << 4, /* Save using multiple parallel streams (Since: 9.2.0) */
 } virDomainSaveRestoreFlags;
 
 int                     virDomainSave           (virDomainPtr domain,
@@ -1615,6 +1637,19 @@ int                     virDomainRestoreParams  (virConnectPtr conn,
  */
 # define VIR_DOMAIN_SAVE_PARAM_DXML             "dxml"
 
+/**
+ * VIR_DOMAIN_SAVE_PARAM_PARALLEL_CHANNELS:
+ *
+ * an optional parameter used to specify the number of additional channels
+ * used for a parallel save (see VIR_DOMAIN_SAVE_PARALLEL) as
+ * VIR_TYPED_PARAM_INT. Each channel is stored in a separate file next to
+ * the main save image. Restoring such an image reads all channels
+ * concurrently and needs no extra parameters.
+ *
+ * Since: 9.2.0
+ */
+# define VIR_DOMAIN_SAVE_PARAM_PARALLEL_CHANNELS "parallel.channels"
+
 /* See below for virDomainSaveImageXMLFlags */
 char *          virDomainSaveImageGetXMLDesc    (virConnectPtr conn,
                                                  const char *file,
@@ -2711,6 +2746,7 @@ typedef enum {
     VIR_DOMAIN_STATS_MEMORY = (1 << 8), /* return domain memory info (Since: 6.0.0) */
     VIR_DOMAIN_STATS_DIRTYRATE = (1 << 9), /* return domain dirty rate info (Since: 7.2.0) */
     VIR_DOMAIN_STATS_VM = (1 << 10), /* return vm info (Since: 8.9.0) */
+    VIR_DOMAIN_STATS_STARTUP = (1 << 11), /* return startup timing info (Since: 9.2.0) */
 } virDomainStatsTypes;
 
 /**
@@ -4226,6 +4262,56 @@ typedef enum {
  */
 # define VIR_DOMAIN_JOB_TIME_REMAINING           "time_remaining"
 
+/**
+ * VIR_DOMAIN_JOB_TIME_PHASE_BEGIN:
+ *
+ * virDomainGetJobStats field: time (ms) the source host spent processing
+ * the Begin phase of migration, as VIR_TYPED_PARAM_ULLONG.
+ *
+ * Since: 9.2.0
+ */
+# define VIR_DOMAIN_JOB_TIME_PHASE_BEGIN         "time_phase_begin"
+
+/**
+ * VIR_DOMAIN_JOB_TIME_PHASE_PREPARE:
+ *
+ * virDomainGetJobStats field: time (ms) the destination host spent
+ * processing the Prepare phase of migration, as VIR_TYPED_PARAM_ULLONG.
+ *
+ * Since: 9.2.0
+ */
+# define VIR_DOMAIN_JOB_TIME_PHASE_PREPARE       "time_phase_prepare"
+
+/**
+ * VIR_DOMAIN_JOB_TIME_PHASE_PERFORM:
+ *
+ * virDomainGetJobStats field: time (ms) the source host spent processing
+ * the Perform phase of migration, as VIR_TYPED_PARAM_ULLONG.
+ *
+ * Since: 9.2.0
+ */
+# define VIR_DOMAIN_JOB_TIME_PHASE_PERFORM       "time_phase_perform"
+
+/**
+ * VIR_DOMAIN_JOB_TIME_PHASE_FINISH:
+ *
+ * virDomainGetJobStats field: time (ms) the destination host spent
+ * processing the Finish phase of migration, as VIR_TYPED_PARAM_ULLONG.
+ *
+ * Since: 9.2.0
+ */
+# define VIR_DOMAIN_JOB_TIME_PHASE_FINISH        "time_phase_finish"
+
+/**
+ * VIR_DOMAIN_JOB_TIME_PHASE_CONFIRM:
+ *
+ * virDomainGetJobStats field: time (ms) the source host spent processing
+ * the Confirm phase of migration, as VIR_TYPED_PARAM_ULLONG.
+ *
+ * Since: 9.2.0
+ */
+# define VIR_DOMAIN_JOB_TIME_PHASE_CONFIRM       "time_phase_confirm"
+
 /**
  * VIR_DOMAIN_JOB_DOWNTIME:
  *
@@ -4479,6 +4565,17 @@ typedef enum {
  */
 # define VIR_DOMAIN_JOB_DISK_BPS                 "disk_bps"
 
+/**
+ * VIR_DOMAIN_JOB_DISK_TIME_REMAINING:
+ *
+ * virDomainGetJobStats field: estimated time (ms) needed to finish the
+ * initial copy of guest disks during migration with non-shared storage,
+ * as VIR_TYPED_PARAM_ULLONG.
+ *
+ * Since: 9.2.0
+ */
+# define VIR_DOMAIN_JOB_DISK_TIME_REMAINING      "disk_time_remaining"
+
 /**
  * VIR_DOMAIN_JOB_COMPRESSION_CACHE:
  *
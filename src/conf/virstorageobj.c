@@ -91,6 +91,10 @@ struct _virStoragePoolObj {
     virStoragePoolDef *newDef;
 
     virStorageVolObjList *volumes;
+
+    /* name string -> virStorageVolDef mapping of volumes detached from
+     * the pool by virStoragePoolObjStashVols */
+    GHashTable *stashedVols;
 };
 
 struct _virStoragePoolObjList {
@@ -348,6 +352,7 @@ virStoragePoolObjDispose(void *opaque)
 
     virStoragePoolObjClearVols(obj);
     virObjectUnref(obj->volumes);
+    virStoragePoolObjDropStashedVols(obj);
 
     virStoragePoolDefFree(obj->def);
     virStoragePoolDefFree(obj->newDef);
@@ -609,6 +614,87 @@ virStoragePoolObjClearVols(virStoragePoolObj *obj)
 }
 
 
+/**
+ * virStoragePoolObjStashVols:
+ * @obj: storage pool object
+ *
+ * Removes all volumes from the pool as virStoragePoolObjClearVols does, but
+ * keeps their definitions aside so that a pool refresh can pick the ones
+ * which did not change using virStoragePoolObjTakeStashedVol instead of
+ * probing them again. Definitions which were not taken are freed by
+ * virStoragePoolObjDropStashedVols.
+ */
+void
+virStoragePoolObjStashVols(virStoragePoolObj *obj)
+{
+    virStorageVolObjList *volumes = obj->volumes;
+    GHashTableIter htitr;
+    void *value;
+
+    virStoragePoolObjDropStashedVols(obj);
+
+    if (!volumes)
+        return;
+
+    obj->stashedVols = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                             (GDestroyNotify) virStorageVolDefFree);
+
+    virObjectRWLockWrite(volumes);
+
+    g_hash_table_iter_init(&htitr, volumes->objsName);
+    while (g_hash_table_iter_next(&htitr, NULL, &value)) {
+        virStorageVolObj *volobj = value;
+        VIR_LOCK_GUARD lock = virObjectLockGuard(volobj);
+
+        if (!volobj->voldef)
+            continue;
+
+        g_hash_table_insert(obj->stashedVols,
+                            g_strdup(volobj->voldef->name),
+                            g_steal_pointer(&volobj->voldef));
+    }
+
+    g_hash_table_remove_all(volumes->objsKey);
+    g_hash_table_remove_all(volumes->objsName);
+    g_hash_table_remove_all(volumes->objsPath);
+
+    virObjectRWUnlock(volumes);
+}
+
+
+/**
+ * virStoragePoolObjTakeStashedVol:
+ * @obj: storage pool object
+ * @name: volume name
+ *
+ * Returns the definition of volume @name stashed by
+ * virStoragePoolObjStashVols and transfers its ownership to the caller, or
+ * NULL if there is no such volume.
+ */
+virStorageVolDef *
+virStoragePoolObjTakeStashedVol(virStoragePoolObj *obj,
+                                const char *name)
+{
+    void *key = NULL;
+    void *voldef = NULL;
+
+    if (!obj->stashedVols ||
+        !g_hash_table_lookup_extended(obj->stashedVols, name, &key, &voldef))
+        return NULL;
+
+    g_hash_table_steal(obj->stashedVols, name);
+    g_free(key);
+    return voldef;
+}
+
+
+void
+virStoragePoolObjDropStashedVols(virStoragePoolObj *obj)
+{
+    g_clear_pointer(&obj->stashedVols, g_hash_table_unref);
+}
+
+
 int
 virStoragePoolObjAddVol(virStoragePoolObj *obj,
                         virStorageVolDef *voldef)
@@ -22,6 +22,7 @@
 #include "internal.h"
 
 #include "storage_conf.h"
+#include "virthreadpool.h"
 
 typedef struct _virStoragePoolObj virStoragePoolObj;
 
@@ -46,6 +47,9 @@ struct _virStorageDriverState {
 
     /* Immutable pointer, read only after initialized */
     virCaps *caps;
+
+    /* Immutable pointer, self-locking APIs */
+    virThreadPool *volBuildPool;
 };
 
 typedef bool
@@ -171,6 +175,16 @@ virStorageVolDefFindByName(virStoragePoolObj *obj,
 void
 virStoragePoolObjClearVols(virStoragePoolObj *obj);
 
+void
+virStoragePoolObjStashVols(virStoragePoolObj *obj);
+
+virStorageVolDef *
+virStoragePoolObjTakeStashedVol(virStoragePoolObj *obj,
+                                const char *name);
+
+void
+virStoragePoolObjDropStashedVols(virStoragePoolObj *obj);
+
 typedef bool
 (*virStoragePoolVolumeACLFilter)(virConnectPtr conn,
                                  virStoragePoolDef *pool,
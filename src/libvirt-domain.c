@@ -1010,6 +1010,11 @@ virDomainSaveFlags(virDomainPtr domain, const char *to,
  * If VIR_DOMAIN_SAVE_PARAM_FILE is not provided then a managed save is
  * performed (see virDomainManagedSave).
  *
+ * If @flags includes VIR_DOMAIN_SAVE_PARALLEL, the memory state is written
+ * using VIR_DOMAIN_SAVE_PARAM_PARALLEL_CHANNELS additional streams in
+ * parallel, each stored in its own file named after the save image with a
+ * ".N" suffix. Such images cannot be compressed.
+ *
  * Returns 0 in case of success and -1 in case of failure.
  *
  * Since: 8.4.0
@@ -12527,6 +12532,23 @@ virConnectGetDomainCapabilities(virConnectPtr conn,
  *      naming or meaning will stay consistent. Changes to existing fields,
  *      however, are expected to be rare.
  *
+ * VIR_DOMAIN_STATS_STARTUP:
+ *     Return the time spent in individual phases of the most recent startup
+ *     of the domain (including startup as the destination of an incoming
+ *     migration). The data is kept after the domain is stopped so that
+ *     failed startups can be analyzed as well. The typed parameter keys are
+ *     in this format:
+ *
+ *     "startup.time" - total time spent in all recorded phases in
+ *                      microseconds as unsigned long long.
+ *     "startup.phase.count" - number of recorded startup phases as
+ *                             unsigned int.
+ *     "startup.phase.<num>.name" - name of the startup phase <num> as string.
+ *                                  Names of the phases are hypervisor
+ *                                  specific.
+ *     "startup.phase.<num>.time" - time spent in startup phase <num> in
+ *                                  microseconds as unsigned long long.
+ *
  * Note that entire stats groups or individual stat fields may be missing from
  * the output in case they are not supported by the given hypervisor, are not
  * applicable for the current state of the guest domain, or their retrieval
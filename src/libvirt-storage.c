@@ -1569,6 +1569,13 @@ virStorageVolGetKey(virStorageVolPtr vol)
  * qcow2 image files which don't support full preallocation,
  * by creating a sparse image file with metadata.
  *
+ * Since 9.2.0 VIR_STORAGE_VOL_CREATE_BACKGROUND in flags makes the
+ * API return as soon as the volume is defined, while its data is
+ * written in the background. Until then the volume can't be used,
+ * its allocation reflects the progress, and once it is done (or
+ * the volume was removed after a failure) a
+ * VIR_STORAGE_POOL_EVENT_ID_REFRESH event is emitted for the pool.
+ *
  * virStorageVolFree should be used to free the resources after the
  * storage volume object is no longer needed.
  *
@@ -1622,6 +1629,13 @@ virStorageVolCreateXML(virStoragePoolPtr pool,
  * qcow2 image files which don't support full preallocation,
  * by creating a sparse image file with metadata.
  *
+ * Since 9.2.0 VIR_STORAGE_VOL_CREATE_BACKGROUND in flags makes the
+ * API return as soon as the volume is defined, while its data is
+ * written in the background. Until then the volume can't be used,
+ * its allocation reflects the progress, and once it is done (or
+ * the volume was removed after a failure) a
+ * VIR_STORAGE_POOL_EVENT_ID_REFRESH event is emitted for the pool.
+ *
  * virStorageVolFree should be used to free the resources after the
  * storage volume object is no longer needed.
  *
@@ -615,6 +615,10 @@ virQEMUDriverConfigLoadSaveEntry(virQEMUDriverConfig *cfg,
         return -1;
     if (virConfGetValueString(conf, "snapshot_image_format", &cfg->snapshotImageFormat) < 0)
         return -1;
+    if (virConfGetValueUInt(conf, "zstd_compression_level", &cfg->zstdCompressionLevel) < 0)
+        return -1;
+    if (virConfGetValueUInt(conf, "zstd_compression_threads", &cfg->zstdCompressionThreads) < 0)
+        return -1;
     if (virConfGetValueString(conf, "auto_dump_path", &cfg->autoDumpPath) < 0)
         return -1;
     if (virConfGetValueBool(conf, "auto_dump_bypass_cache", &cfg->autoDumpBypassCache) < 0)
@@ -823,6 +827,10 @@ virQEMUDriverConfigLoadNetworkEntry(virQEMUDriverConfig *cfg,
         return -1;
     }
 
+    if (virConfGetValueUInt(conf, "migration_max_parallel_disks",
+                            &cfg->migrationMaxParallelDisks) < 0)
+        return -1;
+
     if (virConfGetValueString(conf, "migration_address", &cfg->migrationAddress) < 0)
         return -1;
     virStringStripIPv6Brackets(cfg->migrationAddress);
@@ -1155,6 +1163,13 @@ int virQEMUDriverConfigLoadFile(virQEMUDriverConfig *cfg,
 int
 virQEMUDriverConfigValidate(virQEMUDriverConfig *cfg)
 {
+    if (cfg->zstdCompressionLevel > 19) {
+        virReportError(VIR_ERR_CONF_SYNTAX,
+                       _("zstd_compression_level '%u' must be between 0 and 19"),
+                       cfg->zstdCompressionLevel);
+        return -1;
+    }
+
     if (cfg->defaultTLSx509certdirPresent) {
         if (!virFileExists(cfg->defaultTLSx509certdir)) {
             virReportError(VIR_ERR_CONF_SYNTAX,
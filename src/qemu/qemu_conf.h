@@ -194,6 +194,8 @@ struct _virQEMUDriverConfig {
     char *saveImageFormat;
     char *dumpImageFormat;
     char *snapshotImageFormat;
+    unsigned int zstdCompressionLevel;
+    unsigned int zstdCompressionThreads;
 
     char *autoDumpPath;
     bool autoDumpBypassCache;
@@ -211,6 +213,7 @@ struct _virQEMUDriverConfig {
     char *migrationAddress;
     unsigned int migrationPortMin;
     unsigned int migrationPortMax;
+    unsigned int migrationMaxParallelDisks;
 
     bool logTimestamp;
     bool stdioLogD;
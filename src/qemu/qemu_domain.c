@@ -7397,6 +7397,103 @@ qemuDomainRemoveInactiveLocked(virQEMUDriver *driver,
     virDomainObjListRemoveLocked(driver->domains, vm);
 }
 
+VIR_ENUM_IMPL(qemuDomainStartupPhase,
+              QEMU_DOMAIN_STARTUP_PHASE_LAST,
+              "init",
+              "prepare-domain",
+              "prepare-host",
+              "ext-devices",
+              "command-line",
+              "spawn",
+              "namespace",
+              "cgroup",
+              "host-tuning",
+              "security-label",
+              "monitor",
+              "vcpus",
+              "devices",
+              "incoming",
+              "refresh-state",
+              "finish",
+);
+
+
+/**
+ * qemuDomainStartupPhasesReset:
+ * @vm: domain object
+ *
+ * Forgets the startup timing report of the previous run of @vm. Must be
+ * called only while @vm is inactive, at the very beginning of its startup.
+ */
+void
+qemuDomainStartupPhasesReset(virDomainObj *vm)
+{
+    qemuDomainObjPrivate *priv = vm->privateData;
+
+    memset(priv->startupPhases, 0, sizeof(priv->startupPhases));
+}
+
+
+/**
+ * qemuDomainStartupPhaseEnd:
+ * @vm: domain object
+ * @phase: startup phase which has just finished
+ * @since: monotonic timestamp (in microseconds) of the beginning of @phase
+ *
+ * Accounts the time elapsed since @since to @phase in the startup timing
+ * report of @vm and updates @since to the current time so that it can be
+ * directly used as the beginning of the following phase.
+ */
+void
+qemuDomainStartupPhaseEnd(virDomainObj *vm,
+                          qemuDomainStartupPhase phase,
+                          unsigned long long *since)
+{
+    qemuDomainObjPrivate *priv = vm->privateData;
+    unsigned long long now = g_get_monotonic_time();
+
+    if (now > *since)
+        priv->startupPhases[phase] += now - *since;
+
+    VIR_DEBUG("domain '%s' startup phase '%s' took %lluus",
+              vm->def->name, qemuDomainStartupPhaseTypeToString(phase),
+              now - *since);
+
+    *since = now;
+}
+
+
+/**
+ * qemuDomainStartupPhasesLog:
+ * @vm: domain object
+ *
+ * Logs a summary of the time spent in individual startup phases of @vm.
+ */
+void
+qemuDomainStartupPhasesLog(virDomainObj *vm)
+{
+    qemuDomainObjPrivate *priv = vm->privateData;
+    g_auto(virBuffer) buf = VIR_BUFFER_INITIALIZER;
+    unsigned long long total = 0;
+    size_t i;
+
+    for (i = 0; i < QEMU_DOMAIN_STARTUP_PHASE_LAST; i++) {
+        if (priv->startupPhases[i] == 0)
+            continue;
+
+        virBufferAsprintf(&buf, " %s=%llu.%03llums",
+                          qemuDomainStartupPhaseTypeToString(i),
+                          priv->startupPhases[i] / 1000,
+                          priv->startupPhases[i] % 1000);
+        total += priv->startupPhases[i];
+    }
+
+    VIR_INFO("Startup of domain '%s' took %llu.%03llums:%s",
+             vm->def->name, total / 1000, total % 1000,
+             NULLSTR_EMPTY(virBufferCurrentContent(&buf)));
+}
+
+
 void
 qemuDomainSetFakeReboot(virDomainObj *vm,
                         bool value)
@@ -12014,6 +12111,35 @@ qemuDomainObjWait(virDomainObj *vm)
 }
 
 
+/**
+ * qemuDomainObjWaitUntil:
+ * @vm: domain object
+ * @whenms: absolute time in milliseconds to wait until
+ *
+ * Same as qemuDomainObjWait(), but gives up waiting at @whenms.
+ *
+ * Returns 0 when the domain condition was signalled, 1 on timeout, and -1 on
+ * error.
+ */
+int
+qemuDomainObjWaitUntil(virDomainObj *vm,
+                       unsigned long long whenms)
+{
+    qemuDomainObjPrivate *priv = vm->privateData;
+    int rc;
+
+    if ((rc = virDomainObjWaitUntil(vm, whenms)) < 0)
+        return -1;
+
+    if (priv->beingDestroyed) {
+        virReportError(VIR_ERR_OPERATION_FAILED, "%s", _("domain is not running"));
+        return -1;
+    }
+
+    return rc;
+}
+
+
 /**
  * virDomainRefreshStatsSchema:
  * @driver: qemu driver data
@@ -77,6 +77,31 @@ struct _qemuDomainUnpluggingDevice {
 };
 
 
+/* phases of domain startup tracked for the startup timing report */
+typedef enum {
+    QEMU_DOMAIN_STARTUP_PHASE_INIT = 0,
+    QEMU_DOMAIN_STARTUP_PHASE_PREPARE_DOMAIN,
+    QEMU_DOMAIN_STARTUP_PHASE_PREPARE_HOST,
+    QEMU_DOMAIN_STARTUP_PHASE_EXT_DEVICES,
+    QEMU_DOMAIN_STARTUP_PHASE_COMMAND_LINE,
+    QEMU_DOMAIN_STARTUP_PHASE_SPAWN,
+    QEMU_DOMAIN_STARTUP_PHASE_NAMESPACE,
+    QEMU_DOMAIN_STARTUP_PHASE_CGROUP,
+    QEMU_DOMAIN_STARTUP_PHASE_HOST_TUNING,
+    QEMU_DOMAIN_STARTUP_PHASE_SECURITY_LABEL,
+    QEMU_DOMAIN_STARTUP_PHASE_MONITOR,
+    QEMU_DOMAIN_STARTUP_PHASE_VCPUS,
+    QEMU_DOMAIN_STARTUP_PHASE_DEVICES,
+    QEMU_DOMAIN_STARTUP_PHASE_INCOMING,
+    QEMU_DOMAIN_STARTUP_PHASE_REFRESH_STATE,
+    QEMU_DOMAIN_STARTUP_PHASE_FINISH,
+
+    QEMU_DOMAIN_STARTUP_PHASE_LAST
+} qemuDomainStartupPhase;
+
+VIR_ENUM_DECL(qemuDomainStartupPhase);
+
+
 #define QEMU_PROC_MOUNTS "/proc/mounts"
 #define QEMU_DEVPREFIX "/dev/"
 #define QEMU_DEV_VFIO "/dev/vfio/vfio"
@@ -253,6 +278,11 @@ struct _qemuDomainObjPrivate {
 
     /* named file descriptor groups associated with the VM */
     GHashTable *fds;
+
+    /* Time in microseconds spent in individual phases of the most recent
+     * startup of the domain. Kept after the domain stops so that failed
+     * startups can be inspected too. Not saved in status XML. */
+    unsigned long long startupPhases[QEMU_DOMAIN_STARTUP_PHASE_LAST];
 };
 
 #define QEMU_DOMAIN_PRIVATE(vm) \
@@ -710,6 +740,12 @@ void
 qemuDomainRemoveInactiveLocked(virQEMUDriver *driver,
                                virDomainObj *vm);
 
+void qemuDomainStartupPhasesReset(virDomainObj *vm);
+void qemuDomainStartupPhaseEnd(virDomainObj *vm,
+                               qemuDomainStartupPhase phase,
+                               unsigned long long *since);
+void qemuDomainStartupPhasesLog(virDomainObj *vm);
+
 void qemuDomainSetFakeReboot(virDomainObj *vm,
                              bool value);
 
@@ -1118,6 +1154,10 @@ qemuDomainRemoveLogs(virQEMUDriver *driver,
 int
 qemuDomainObjWait(virDomainObj *vm);
 
+int
+qemuDomainObjWaitUntil(virDomainObj *vm,
+                       unsigned long long whenms);
+
 int
 qemuDomainRefreshStatsSchema(virDomainObj *dom);
 
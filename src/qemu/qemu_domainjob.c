@@ -248,6 +248,16 @@ qemuDomainJobDataToInfo(virDomainJobData *jobData,
 }
 
 
+static const char *qemuDomainJobPhaseTimeParams[] = {
+    [QEMU_DOMAIN_JOB_PHASE_TIME_BEGIN] = VIR_DOMAIN_JOB_TIME_PHASE_BEGIN,
+    [QEMU_DOMAIN_JOB_PHASE_TIME_PREPARE] = VIR_DOMAIN_JOB_TIME_PHASE_PREPARE,
+    [QEMU_DOMAIN_JOB_PHASE_TIME_PERFORM] = VIR_DOMAIN_JOB_TIME_PHASE_PERFORM,
+    [QEMU_DOMAIN_JOB_PHASE_TIME_FINISH] = VIR_DOMAIN_JOB_TIME_PHASE_FINISH,
+    [QEMU_DOMAIN_JOB_PHASE_TIME_CONFIRM] = VIR_DOMAIN_JOB_TIME_PHASE_CONFIRM,
+};
+G_STATIC_ASSERT(G_N_ELEMENTS(qemuDomainJobPhaseTimeParams) == QEMU_DOMAIN_JOB_PHASE_TIME_LAST);
+
+
 static int
 qemuDomainMigrationJobDataToParams(virDomainJobData *jobData,
                                    int *type,
@@ -262,6 +272,7 @@ qemuDomainMigrationJobDataToParams(virDomainJobData *jobData,
     int npar = 0;
     unsigned long long mirrorRemaining = mirrorStats->total -
                                          mirrorStats->transferred;
+    size_t i;
 
     if (virTypedParamsAddInt(&par, &npar, &maxpar,
                              VIR_DOMAIN_JOB_OPERATION,
@@ -300,6 +311,14 @@ qemuDomainMigrationJobDataToParams(virDomainJobData *jobData,
                                 stats->setup_time) < 0)
         goto error;
 
+    for (i = 0; i < QEMU_DOMAIN_JOB_PHASE_TIME_LAST; i++) {
+        if (priv->phaseTimes[i] &&
+            virTypedParamsAddULLong(&par, &npar, &maxpar,
+                                    qemuDomainJobPhaseTimeParams[i],
+                                    priv->phaseTimes[i]) < 0)
+            goto error;
+    }
+
     if (virTypedParamsAddULLong(&par, &npar, &maxpar,
                                 VIR_DOMAIN_JOB_DATA_TOTAL,
                                 stats->ram_total +
@@ -389,6 +408,12 @@ qemuDomainMigrationJobDataToParams(virDomainJobData *jobData,
                                 stats->disk_bps) < 0)
         goto error;
 
+    if (mirrorStats->timeRemaining &&
+        virTypedParamsAddULLong(&par, &npar, &maxpar,
+                                VIR_DOMAIN_JOB_DISK_TIME_REMAINING,
+                                mirrorStats->timeRemaining) < 0)
+        goto error;
+
     if (stats->xbzrle_set) {
         if (virTypedParamsAddULLong(&par, &npar, &maxpar,
                                     VIR_DOMAIN_JOB_COMPRESSION_CACHE,
@@ -36,6 +36,8 @@ typedef struct _qemuDomainMirrorStats qemuDomainMirrorStats;
 struct _qemuDomainMirrorStats {
     unsigned long long transferred;
     unsigned long long total;
+    unsigned long long pending; /* size of disks waiting to be mirrored */
+    unsigned long long timeRemaining; /* estimate in ms, 0 if unknown */
 };
 
 typedef struct _qemuDomainBackupStats qemuDomainBackupStats;
@@ -46,6 +48,18 @@ struct _qemuDomainBackupStats {
     unsigned long long tmp_total;
 };
 
+/* Generic migration protocol phases for which the time spent in them is
+ * reported in job statistics */
+typedef enum {
+    QEMU_DOMAIN_JOB_PHASE_TIME_BEGIN,
+    QEMU_DOMAIN_JOB_PHASE_TIME_PREPARE,
+    QEMU_DOMAIN_JOB_PHASE_TIME_PERFORM,
+    QEMU_DOMAIN_JOB_PHASE_TIME_FINISH,
+    QEMU_DOMAIN_JOB_PHASE_TIME_CONFIRM,
+
+    QEMU_DOMAIN_JOB_PHASE_TIME_LAST
+} qemuDomainJobPhaseTime;
+
 typedef struct _qemuDomainJobDataPrivate qemuDomainJobDataPrivate;
 struct _qemuDomainJobDataPrivate {
     /* Raw values from QEMU */
@@ -56,6 +70,11 @@ struct _qemuDomainJobDataPrivate {
         qemuDomainBackupStats backup;
     } stats;
     qemuDomainMirrorStats mirrorStats;
+
+    /* when the current migration phase started, 0 between API calls */
+    unsigned long long phaseStarted;
+    /* time in ms spent in each phase (qemuDomainJobPhaseTime) */
+    unsigned long long phaseTimes[QEMU_DOMAIN_JOB_PHASE_TIME_LAST];
 };
 
 void qemuDomainJobSetStatsType(virDomainJobData *jobData,
@@ -2623,7 +2623,8 @@ static int
 qemuDomainSaveInternal(virQEMUDriver *driver,
                        virDomainObj *vm, const char *path,
                        int compressed, virCommand *compressor,
-                       const char *xmlin, unsigned int flags)
+                       const char *xmlin, unsigned int channels,
+                       unsigned int flags)
 {
     g_autofree char *xml = NULL;
     bool was_running = false;
@@ -2703,6 +2704,8 @@ qemuDomainSaveInternal(virQEMUDriver *driver,
         goto endjob;
     xml = NULL;
 
+    virQEMUSaveDataSetChannels(data, channels);
+
     ret = qemuSaveImageCreate(driver, vm, path, data, compressor,
                               flags, VIR_ASYNC_JOB_SAVE);
     if (ret < 0)
@@ -2755,6 +2758,7 @@ static int
 qemuDomainManagedSaveHelper(virQEMUDriver *driver,
                             virDomainObj *vm,
                             const char *dxml,
+                            unsigned int channels,
                             unsigned int flags)
 {
     g_autoptr(virQEMUDriverConfig) cfg = NULL;
@@ -2772,7 +2776,8 @@ qemuDomainManagedSaveHelper(virQEMUDriver *driver,
     }
 
     cfg = virQEMUDriverGetConfig(driver);
-    if ((compressed = qemuSaveImageGetCompressionProgram(cfg->saveImageFormat,
+    if ((compressed = qemuSaveImageGetCompressionProgram(cfg,
+                                                         cfg->saveImageFormat,
                                                          &compressor,
                                                          "save", false)) < 0)
         return -1;
@@ -2782,7 +2787,7 @@ qemuDomainManagedSaveHelper(virQEMUDriver *driver,
     VIR_INFO("Saving state of domain '%s' to '%s'", vm->def->name, path);
 
     if (qemuDomainSaveInternal(driver, vm, path, compressed,
-                                 compressor, dxml, flags) < 0)
+                                 compressor, dxml, channels, flags) < 0)
         return -1;
 
     vm->hasManagedSave = true;
@@ -2806,7 +2811,8 @@ qemuDomainSaveFlags(virDomainPtr dom, const char *path, const char *dxml,
                   VIR_DOMAIN_SAVE_PAUSED, -1);
 
     cfg = virQEMUDriverGetConfig(driver);
-    if ((compressed = qemuSaveImageGetCompressionProgram(cfg->saveImageFormat,
+    if ((compressed = qemuSaveImageGetCompressionProgram(cfg,
+                                                         cfg->saveImageFormat,
                                                          &compressor,
                                                          "save", false)) < 0)
         goto cleanup;
@@ -2821,7 +2827,7 @@ qemuDomainSaveFlags(virDomainPtr dom, const char *path, const char *dxml,
         goto cleanup;
 
     ret = qemuDomainSaveInternal(driver, vm, path, compressed,
-                                 compressor, dxml, flags);
+                                 compressor, dxml, 0, flags);
 
  cleanup:
     virDomainObjEndAPI(&vm);
@@ -2846,18 +2852,23 @@ qemuDomainSaveParams(virDomainPtr dom,
     g_autoptr(virCommand) compressor = NULL;
     const char *to = NULL;
     const char *dxml = NULL;
+    int channels = 0;
+    int rc;
     int compressed;
     int ret = -1;
 
     virCheckFlags(VIR_DOMAIN_SAVE_BYPASS_CACHE |
                   VIR_DOMAIN_SAVE_RUNNING |
-                  VIR_DOMAIN_SAVE_PAUSED, -1);
+                  VIR_DOMAIN_SAVE_PAUSED |
+                  VIR_DOMAIN_SAVE_PARALLEL, -1);
 
     if (virTypedParamsValidate(params, nparams,
                                VIR_DOMAIN_SAVE_PARAM_FILE,
                                VIR_TYPED_PARAM_STRING,
                                VIR_DOMAIN_SAVE_PARAM_DXML,
                                VIR_TYPED_PARAM_STRING,
+                               VIR_DOMAIN_SAVE_PARAM_PARALLEL_CHANNELS,
+                               VIR_TYPED_PARAM_INT,
                                NULL) < 0)
         return -1;
 
@@ -2867,6 +2878,33 @@ qemuDomainSaveParams(virDomainPtr dom,
     if (virTypedParamsGetString(params, nparams,
                                 VIR_DOMAIN_SAVE_PARAM_DXML, &dxml) < 0)
         return -1;
+    if ((rc = virTypedParamsGetInt(params, nparams,
+                                   VIR_DOMAIN_SAVE_PARAM_PARALLEL_CHANNELS,
+                                   &channels)) < 0)
+        return -1;
+
+    if (flags & VIR_DOMAIN_SAVE_PARALLEL) {
+        /* Same default as QEMU uses for multifd migration */
+        if (rc == 0)
+            channels = 2;
+
+        if (channels < 1) {
+            virReportError(VIR_ERR_INVALID_ARG, "%s",
+                           _("number of parallel save channels must be positive"));
+            return -1;
+        }
+
+        if (channels > QEMU_SAVE_MULTIFD_CHANNELS_MAX) {
+            virReportError(VIR_ERR_INVALID_ARG,
+                           _("number of parallel save channels must not exceed %d"),
+                           QEMU_SAVE_MULTIFD_CHANNELS_MAX);
+            return -1;
+        }
+    } else if (rc == 1) {
+        virReportError(VIR_ERR_INVALID_ARG, "%s",
+                       _("Turn parallel save on to tune it"));
+        return -1;
+    }
 
     if (!(vm = qemuDomainObjFromDomain(dom)))
         goto cleanup;
@@ -2876,11 +2914,13 @@ qemuDomainSaveParams(virDomainPtr dom,
 
     if (!to) {
         /* If no save path was provided then this behaves as managed save. */
-        return qemuDomainManagedSaveHelper(driver, vm, dxml, flags);
+        ret = qemuDomainManagedSaveHelper(driver, vm, dxml, channels, flags);
+        goto cleanup;
     }
 
     cfg = virQEMUDriverGetConfig(driver);
-    if ((compressed = qemuSaveImageGetCompressionProgram(cfg->saveImageFormat,
+    if ((compressed = qemuSaveImageGetCompressionProgram(cfg,
+                                                         cfg->saveImageFormat,
                                                          &compressor,
                                                          "save", false)) < 0)
         goto cleanup;
@@ -2889,7 +2929,7 @@ qemuDomainSaveParams(virDomainPtr dom,
         goto cleanup;
 
     ret = qemuDomainSaveInternal(driver, vm, to, compressed,
-                                 compressor, dxml, flags);
+                                 compressor, dxml, channels, flags);
 
  cleanup:
     virDomainObjEndAPI(&vm);
@@ -2914,7 +2954,7 @@ qemuDomainManagedSave(virDomainPtr dom, unsigned int flags)
     if (virDomainManagedSaveEnsureACL(dom->conn, vm->def) < 0)
         goto cleanup;
 
-    ret = qemuDomainManagedSaveHelper(driver, vm, NULL, flags);
+    ret = qemuDomainManagedSaveHelper(driver, vm, NULL, 0, flags);
 
  cleanup:
     virDomainObjEndAPI(&vm);
@@ -2979,7 +3019,7 @@ qemuDomainManagedSaveRemove(virDomainPtr dom, unsigned int flags)
 
     name = qemuDomainManagedSavePath(driver, vm);
 
-    if (unlink(name) < 0) {
+    if (qemuSaveImageUnlink(name) < 0) {
         virReportSystemError(errno,
                              _("Failed to remove managed save file '%s'"),
                              name);
@@ -3098,7 +3138,8 @@ doCoreDump(virQEMUDriver *driver,
      * format in "save" and "dump". This path doesn't need the compression
      * program to exist and can ignore the return value - it only cares to
      * get the compressor */
-    ignore_value(qemuSaveImageGetCompressionProgram(cfg->dumpImageFormat,
+    ignore_value(qemuSaveImageGetCompressionProgram(cfg,
+                                                    cfg->dumpImageFormat,
                                                     &compressor,
                                                     "dump", true));
 
@@ -6340,7 +6381,7 @@ qemuDomainObjStart(virConnectPtr conn,
 
     if (virFileExists(managed_save)) {
         if (force_boot) {
-            if (unlink(managed_save) < 0) {
+            if (qemuSaveImageUnlink(managed_save) < 0) {
                 virReportSystemError(errno,
                                      _("cannot remove managed save file %s"),
                                      managed_save);
@@ -6356,7 +6397,7 @@ qemuDomainObjStart(virConnectPtr conn,
                                        reset_nvram, asyncJob);
 
             if (ret == 0) {
-                if (unlink(managed_save) < 0)
+                if (qemuSaveImageUnlink(managed_save) < 0)
                     VIR_WARN("Failed to remove the managed state %s", managed_save);
                 else
                     vm->hasManagedSave = false;
@@ -6609,7 +6650,7 @@ qemuDomainUndefineFlags(virDomainPtr dom,
 
     if (virFileExists(name)) {
         if (flags & VIR_DOMAIN_UNDEFINE_MANAGED_SAVE) {
-            if (unlink(name) < 0) {
+            if (qemuSaveImageUnlink(name) < 0) {
                 virReportError(VIR_ERR_INTERNAL_ERROR, "%s",
                                _("Failed to remove domain managed "
                                  "save image"));
@@ -17339,19 +17380,19 @@ qemuDomainGetStatsCpuCgroup(virDomainObj *dom,
     unsigned long long cpu_time = 0;
     unsigned long long user_time = 0;
     unsigned long long sys_time = 0;
-    int err = 0;
 
     if (!priv->cgroup)
         return 0;
 
-    err = virCgroupGetCpuacctUsage(priv->cgroup, &cpu_time);
-    if (!err && virTypedParamListAddULLong(params, cpu_time, "cpu.time") < 0)
-        return -1;
+    if (virCgroupGetCpuacctStats(priv->cgroup, &cpu_time,
+                                 &user_time, &sys_time) < 0) {
+        /* ignore error */
+        return 0;
+    }
 
-    err = virCgroupGetCpuacctStat(priv->cgroup, &user_time, &sys_time);
-    if (!err && virTypedParamListAddULLong(params, user_time, "cpu.user") < 0)
-        return -1;
-    if (!err && virTypedParamListAddULLong(params, sys_time, "cpu.system") < 0)
+    if (virTypedParamListAddULLong(params, cpu_time, "cpu.time") < 0 ||
+        virTypedParamListAddULLong(params, user_time, "cpu.user") < 0 ||
+        virTypedParamListAddULLong(params, sys_time, "cpu.system") < 0)
         return -1;
 
     return 0;
@@ -18321,6 +18362,55 @@ qemuDomainGetStatsDirtyRate(virQEMUDriver *driver G_GNUC_UNUSED,
 }
 
 
+static int
+qemuDomainGetStatsStartup(virQEMUDriver *driver G_GNUC_UNUSED,
+                          virDomainObj *dom,
+                          virTypedParamList *params,
+                          unsigned int privflags G_GNUC_UNUSED)
+{
+    qemuDomainObjPrivate *priv = dom->privateData;
+    unsigned long long total = 0;
+    size_t nphases = 0;
+    size_t i;
+
+    for (i = 0; i < QEMU_DOMAIN_STARTUP_PHASE_LAST; i++) {
+        if (priv->startupPhases[i] == 0)
+            continue;
+
+        total += priv->startupPhases[i];
+        nphases++;
+    }
+
+    if (nphases == 0)
+        return 0;
+
+    if (virTypedParamListAddULLong(params, total, "startup.time") < 0)
+        return -1;
+
+    if (virTypedParamListAddUInt(params, nphases, "startup.phase.count") < 0)
+        return -1;
+
+    nphases = 0;
+    for (i = 0; i < QEMU_DOMAIN_STARTUP_PHASE_LAST; i++) {
+        if (priv->startupPhases[i] == 0)
+            continue;
+
+        if (virTypedParamListAddString(params,
+                                       qemuDomainStartupPhaseTypeToString(i),
+                                       "startup.phase.%zu.name", nphases) < 0)
+            return -1;
+
+        if (virTypedParamListAddULLong(params, priv->startupPhases[i],
+                                       "startup.phase.%zu.time", nphases) < 0)
+            return -1;
+
+        nphases++;
+    }
+
+    return 0;
+}
+
+
 static int
 qemuDomainGetStatsVm(virQEMUDriver *driver G_GNUC_UNUSED,
                      virDomainObj *dom,
@@ -18391,6 +18481,7 @@ static struct qemuDomainGetStatsWorker qemuDomainGetStatsWorkers[] = {
     { qemuDomainGetStatsMemory, VIR_DOMAIN_STATS_MEMORY, false, NULL },
     { qemuDomainGetStatsDirtyRate, VIR_DOMAIN_STATS_DIRTYRATE, true, queryDirtyRateRequired },
     { qemuDomainGetStatsVm, VIR_DOMAIN_STATS_VM, true, queryVmRequired },
+    { qemuDomainGetStatsStartup, VIR_DOMAIN_STATS_STARTUP, false, NULL },
     { NULL, 0, false, NULL }
 };
 
@@ -132,6 +132,76 @@ qemuMigrationJobStart(virDomainObj *vm,
 }
 
 
+static int
+qemuMigrationJobPhaseToTime(qemuMigrationJobPhase phase)
+{
+    switch (phase) {
+    case QEMU_MIGRATION_PHASE_BEGIN3:
+    case QEMU_MIGRATION_PHASE_BEGIN_RESUME:
+        return QEMU_DOMAIN_JOB_PHASE_TIME_BEGIN;
+
+    case QEMU_MIGRATION_PHASE_PREPARE:
+    case QEMU_MIGRATION_PHASE_PREPARE_RESUME:
+        return QEMU_DOMAIN_JOB_PHASE_TIME_PREPARE;
+
+    case QEMU_MIGRATION_PHASE_PERFORM2:
+    case QEMU_MIGRATION_PHASE_PERFORM3:
+    case QEMU_MIGRATION_PHASE_PERFORM3_DONE:
+    case QEMU_MIGRATION_PHASE_PERFORM_RESUME:
+        return QEMU_DOMAIN_JOB_PHASE_TIME_PERFORM;
+
+    case QEMU_MIGRATION_PHASE_FINISH2:
+    case QEMU_MIGRATION_PHASE_FINISH3:
+    case QEMU_MIGRATION_PHASE_FINISH_RESUME:
+        return QEMU_DOMAIN_JOB_PHASE_TIME_FINISH;
+
+    case QEMU_MIGRATION_PHASE_CONFIRM3_CANCELLED:
+    case QEMU_MIGRATION_PHASE_CONFIRM3:
+    case QEMU_MIGRATION_PHASE_CONFIRM_RESUME:
+        return QEMU_DOMAIN_JOB_PHASE_TIME_CONFIRM;
+
+    case QEMU_MIGRATION_PHASE_NONE:
+    case QEMU_MIGRATION_PHASE_POSTCOPY_FAILED:
+    case QEMU_MIGRATION_PHASE_LAST:
+        break;
+    }
+
+    return -1;
+}
+
+
+/**
+ * qemuMigrationJobPhaseUpdateTime:
+ * @vm: domain object
+ * @running: whether the job keeps running in the current API call
+ *
+ * Adds the time elapsed since the current migration phase was entered to
+ * the statistics of the phase. Only the time spent inside migration APIs
+ * is accounted, the time between API calls (when the other side of
+ * migration is working) is not.
+ */
+static void
+qemuMigrationJobPhaseUpdateTime(virDomainObj *vm,
+                                bool running)
+{
+    qemuDomainJobDataPrivate *privJob;
+    unsigned long long now;
+    int phase;
+
+    if (!vm->job->current ||
+        virTimeMillisNow(&now) < 0)
+        return;
+
+    privJob = vm->job->current->privateData;
+    phase = qemuMigrationJobPhaseToTime(vm->job->phase);
+
+    if (phase >= 0 && privJob->phaseStarted > 0 && now > privJob->phaseStarted)
+        privJob->phaseTimes[phase] += now - privJob->phaseStarted;
+
+    privJob->phaseStarted = running ? now : 0;
+}
+
+
 static int
 qemuMigrationCheckPhase(virDomainObj *vm,
                         qemuMigrationJobPhase phase)
@@ -156,6 +226,7 @@ qemuMigrationJobSetPhase(virDomainObj *vm,
     if (qemuMigrationCheckPhase(vm, phase) < 0)
         return -1;
 
+    qemuMigrationJobPhaseUpdateTime(vm, true);
     qemuDomainObjSetJobPhase(vm, phase);
     return 0;
 }
@@ -168,6 +239,7 @@ qemuMigrationJobStartPhase(virDomainObj *vm,
     if (qemuMigrationCheckPhase(vm, phase) < 0)
         return -1;
 
+    qemuMigrationJobPhaseUpdateTime(vm, true);
     qemuDomainObjStartJobPhase(vm, phase);
     return 0;
 }
@@ -177,6 +249,7 @@ static void ATTRIBUTE_NONNULL(1)
 qemuMigrationJobContinue(virDomainObj *vm,
                          qemuDomainCleanupCallback cleanup)
 {
+    qemuMigrationJobPhaseUpdateTime(vm, false);
     qemuDomainCleanupAdd(vm, cleanup);
     qemuDomainObjReleaseAsyncJob(vm);
 }
@@ -204,6 +277,21 @@ qemuMigrationJobIsActive(virDomainObj *vm,
 static void ATTRIBUTE_NONNULL(1)
 qemuMigrationJobFinish(virDomainObj *vm)
 {
+    qemuMigrationJobPhaseUpdateTime(vm, false);
+
+    /* Completed job statistics are a snapshot taken when migration finished,
+     * let them include the time spent in the remaining phases. */
+    if (vm->job->current && vm->job->completed) {
+        qemuDomainJobDataPrivate *cur = vm->job->current->privateData;
+        qemuDomainJobDataPrivate *completed = vm->job->completed->privateData;
+        size_t i;
+
+        for (i = 0; i < QEMU_DOMAIN_JOB_PHASE_TIME_LAST; i++) {
+            if (cur->phaseTimes[i])
+                completed->phaseTimes[i] = cur->phaseTimes[i];
+        }
+    }
+
     virDomainObjEndAsyncJob(vm);
 }
 
@@ -1114,6 +1202,249 @@ qemuMigrationSrcNBDStorageCopyOne(virDomainObj *vm,
 }
 
 
+/* How often the disk mirrors are rebalanced during the initial copy */
+#define QEMU_MIGRATION_MIRROR_BALANCE_INTERVAL 1000
+/* Smallest bandwidth share (in bytes/s) given to a single disk mirror */
+#define QEMU_MIGRATION_MIRROR_SPEED_MIN (1024 * 1024)
+
+typedef struct _qemuMigrationMirror qemuMigrationMirror;
+struct _qemuMigrationMirror {
+    virDomainDiskDef *disk;
+    unsigned long long size;      /* virtual size of the disk */
+    unsigned long long done;      /* bytes copied so far */
+    unsigned long long remaining; /* bytes left for the initial copy */
+    unsigned long long speed;     /* bandwidth assigned to the mirror */
+    bool started;
+    bool ready;
+};
+
+
+static int
+qemuMigrationMirrorCompare(const void *a,
+                           const void *b)
+{
+    const qemuMigrationMirror *ma = a;
+    const qemuMigrationMirror *mb = b;
+
+    if (ma->size < mb->size)
+        return -1;
+    if (ma->size > mb->size)
+        return 1;
+    return 0;
+}
+
+
+/**
+ * qemuMigrationSrcNBDMirrorsNew:
+ * @vm: domain
+ * @nmigrate_disks: number of disks in @migrate_disks
+ * @migrate_disks: disks selected for migration by the user
+ * @nmirrors: returns the number of disks to be mirrored
+ *
+ * Collects the disks which need to be copied to the destination, sorted by
+ * their size so that small disks (typically the OS ones) are not stuck
+ * behind huge data disks.
+ *
+ * Returns the list of disks to mirror (possibly empty) or NULL on error.
+ */
+static qemuMigrationMirror *
+qemuMigrationSrcNBDMirrorsNew(virDomainObj *vm,
+                              size_t nmigrate_disks,
+                              const char **migrate_disks,
+                              size_t *nmirrors)
+{
+    g_autoptr(GHashTable) nodedata = NULL;
+    g_autofree qemuMigrationMirror *mirrors = NULL;
+    size_t i;
+
+    *nmirrors = 0;
+
+    if (!(nodedata = qemuBlockGetNamedNodeData(vm, VIR_ASYNC_JOB_MIGRATION_OUT)))
+        return NULL;
+
+    mirrors = g_new0(qemuMigrationMirror, vm->def->ndisks + 1);
+
+    for (i = 0; i < vm->def->ndisks; i++) {
+        virDomainDiskDef *disk = vm->def->disks[i];
+        qemuMigrationMirror *m;
+        qemuBlockNamedNodeData *data;
+
+        /* check whether disk should be migrated */
+        if (!qemuMigrationAnyCopyDisk(disk, nmigrate_disks, migrate_disks))
+            continue;
+
+        m = &mirrors[(*nmirrors)++];
+        m->disk = disk;
+        if ((data = virHashLookup(nodedata, qemuDomainDiskGetTopNodename(disk))))
+            m->size = data->capacity;
+        m->remaining = m->size;
+    }
+
+    qsort(mirrors, *nmirrors, sizeof(*mirrors), qemuMigrationMirrorCompare);
+
+    return g_steal_pointer(&mirrors);
+}
+
+
+/**
+ * qemuMigrationSrcNBDMirrorsUpdate:
+ * @vm: domain
+ * @mirrors: list of disk mirrors
+ * @nmirrors: number of items in @mirrors
+ *
+ * Refreshes the progress of all mirrors which are still performing their
+ * initial copy and marks those that became ready.
+ *
+ * Returns 0 on success, -1 on error (including a failed mirror).
+ */
+static int
+qemuMigrationSrcNBDMirrorsUpdate(virDomainObj *vm,
+                                 qemuMigrationMirror *mirrors,
+                                 size_t nmirrors)
+{
+    qemuDomainObjPrivate *priv = vm->privateData;
+    g_autoptr(GHashTable) blockinfo = NULL;
+    size_t i;
+
+    for (i = 0; i < nmirrors; i++) {
+        if (mirrors[i].started && !mirrors[i].ready)
+            break;
+    }
+
+    if (i == nmirrors)
+        return 0;
+
+    if (qemuDomainObjEnterMonitorAsync(vm, VIR_ASYNC_JOB_MIGRATION_OUT) < 0)
+        return -1;
+
+    blockinfo = qemuMonitorGetAllBlockJobInfo(priv->mon, false);
+
+    qemuDomainObjExitMonitor(vm);
+    if (!blockinfo)
+        return -1;
+
+    for (i = 0; i < nmirrors; i++) {
+        qemuMigrationMirror *m = &mirrors[i];
+        qemuMonitorBlockJobInfo *info;
+        qemuBlockJobData *job;
+
+        if (!m->started || m->ready)
+            continue;
+
+        if (!(job = qemuBlockJobDiskGetJob(m->disk))) {
+            virReportError(VIR_ERR_INTERNAL_ERROR,
+                           _("missing block job data for disk '%s'"),
+                           m->disk->dst);
+            return -1;
+        }
+
+        qemuBlockJobUpdate(vm, job, VIR_ASYNC_JOB_MIGRATION_OUT);
+        if (job->state == VIR_DOMAIN_BLOCK_JOB_FAILED) {
+            qemuMigrationNBDReportMirrorError(job, m->disk->dst);
+            virObjectUnref(job);
+            return -1;
+        }
+
+        if (job->state == VIR_DOMAIN_BLOCK_JOB_READY) {
+            VIR_DEBUG("Disk mirror of '%s' is ready", m->disk->dst);
+            m->ready = true;
+            m->done = m->size;
+            m->remaining = 0;
+        } else if ((info = virHashLookup(blockinfo, m->disk->info.alias))) {
+            m->done = info->cur;
+            m->remaining = info->end > info->cur ? info->end - info->cur : 0;
+        }
+
+        virObjectUnref(job);
+    }
+
+    return 0;
+}
+
+
+/**
+ * qemuMigrationSrcNBDMirrorsBalance:
+ * @vm: domain
+ * @mirrors: list of disk mirrors
+ * @nmirrors: number of items in @mirrors
+ * @speed: total bandwidth limit in bytes/s, 0 for unlimited
+ *
+ * Splits @speed between the mirrors performing their initial copy in
+ * proportion to the amount of data they have left so that they finish at
+ * about the same time. Mirrors which are already ready only keep up with
+ * guest writes and get the whole @speed back so that they are never
+ * throttled below the per-disk bandwidth requested by the user.
+ *
+ * Returns 0 on success, -1 on error.
+ */
+static int
+qemuMigrationSrcNBDMirrorsBalance(virDomainObj *vm,
+                                  qemuMigrationMirror *mirrors,
+                                  size_t nmirrors,
+                                  unsigned long long speed)
+{
+    qemuDomainObjPrivate *priv = vm->privateData;
+    unsigned long long remaining = 0;
+    size_t i;
+
+    if (speed == 0)
+        return 0;
+
+    for (i = 0; i < nmirrors; i++) {
+        if (mirrors[i].started && !mirrors[i].ready)
+            remaining += mirrors[i].remaining;
+    }
+
+    for (i = 0; i < nmirrors; i++) {
+        qemuMigrationMirror *m = &mirrors[i];
+        g_autoptr(qemuBlockJobData) job = NULL;
+        unsigned long long share;
+        int rc;
+
+        if (!m->started)
+            continue;
+
+        if (m->ready) {
+            share = speed;
+        } else {
+            if (remaining == 0)
+                continue;
+
+            share = (double) speed * m->remaining / remaining;
+            share = MAX(share, QEMU_MIGRATION_MIRROR_SPEED_MIN);
+        }
+
+        if (share == m->speed)
+            continue;
+
+        /* avoid talking to QEMU for insignificant changes */
+        if (!m->ready &&
+            share > m->speed - m->speed / 10 &&
+            share < m->speed + m->speed / 10)
+            continue;
+
+        if (!(job = qemuBlockJobDiskGetJob(m->disk)))
+            continue;
+
+        VIR_DEBUG("Setting speed of disk mirror '%s' to %llu bytes/s "
+                  "(%llu bytes remaining)", m->disk->dst, share, m->remaining);
+
+        if (qemuDomainObjEnterMonitorAsync(vm, VIR_ASYNC_JOB_MIGRATION_OUT) < 0)
+            return -1;
+
+        rc = qemuMonitorBlockJobSetSpeed(priv->mon, job->name, share);
+
+        qemuDomainObjExitMonitor(vm);
+        if (rc < 0)
+            return -1;
+
+        m->speed = share;
+    }
+
+    return 0;
+}
+
+
 /**
  * qemuMigrationSrcNBDStorageCopy:
  * @driver: qemu driver
@@ -1124,6 +1455,8 @@ qemuMigrationSrcNBDStorageCopyOne(virDomainObj *vm,
  *
  * Migrate non-shared storage using the NBD protocol to the server running
  * inside the qemu process on dst and wait until the copy converges.
+ * Disks are mirrored smallest first, at most migration_max_parallel_disks
+ * of them at a time, with the bandwidth limit shared among them.
  * On failure, the caller is expected to call qemuMigrationSrcNBDCopyCancel
  * to stop all running copy operations.
  *
@@ -1149,7 +1482,11 @@ qemuMigrationSrcNBDStorageCopy(virQEMUDriver *driver,
     size_t i;
     unsigned long long mirror_speed = speed;
     bool mirror_shallow = flags & VIR_MIGRATE_NON_SHARED_INC;
-    int rv;
+    g_autofree qemuMigrationMirror *mirrors = NULL;
+    size_t nmirrors = 0;
+    qemuDomainJobDataPrivate *privJob = vm->job->current->privateData;
+    qemuDomainMirrorStats *mirrorStats = &privJob->mirrorStats;
+    unsigned long long start;
     g_autoptr(virQEMUDriverConfig) cfg = virQEMUDriverGetConfig(driver);
     g_autoptr(virURI) uri = NULL;
     const char *socket = NULL;
@@ -1207,29 +1544,75 @@ qemuMigrationSrcNBDStorageCopy(virQEMUDriver *driver,
         }
     }
 
-    for (i = 0; i < vm->def->ndisks; i++) {
-        virDomainDiskDef *disk = vm->def->disks[i];
+    if (!(mirrors = qemuMigrationSrcNBDMirrorsNew(vm, nmigrate_disks,
+                                                  migrate_disks, &nmirrors)))
+        return -1;
 
-        /* check whether disk should be migrated */
-        if (!qemuMigrationAnyCopyDisk(disk, nmigrate_disks, migrate_disks))
-            continue;
+    if (virTimeMillisNow(&start) < 0)
+        return -1;
 
-        if (qemuMigrationSrcNBDStorageCopyOne(vm, disk, host, port,
-                                              socket,
-                                              mirror_speed, mirror_shallow,
-                                              tlsAlias, tlsHostname, flags) < 0)
-            return -1;
+    while (true) {
+        size_t active = 0;
+        unsigned long long pending = 0;
+        unsigned long long remaining = 0;
+        unsigned long long done = 0;
+        unsigned long long now;
 
-        if (virDomainObjSave(vm, driver->xmlopt, cfg->stateDir) < 0) {
-            VIR_WARN("Failed to save status on vm %s", vm->def->name);
+        if (qemuMigrationSrcNBDMirrorsUpdate(vm, mirrors, nmirrors) < 0)
             return -1;
+
+        for (i = 0; i < nmirrors; i++) {
+            qemuMigrationMirror *m = &mirrors[i];
+
+            if (!m->started &&
+                (cfg->migrationMaxParallelDisks == 0 ||
+                 active < cfg->migrationMaxParallelDisks)) {
+                VIR_DEBUG("Starting disk mirror of '%s' (%llu bytes)",
+                          m->disk->dst, m->size);
+
+                if (qemuMigrationSrcNBDStorageCopyOne(vm, m->disk, host, port,
+                                                      socket,
+                                                      mirror_speed, mirror_shallow,
+                                                      tlsAlias, tlsHostname, flags) < 0)
+                    return -1;
+
+                if (virDomainObjSave(vm, driver->xmlopt, cfg->stateDir) < 0) {
+                    VIR_WARN("Failed to save status on vm %s", vm->def->name);
+                    return -1;
+                }
+
+                m->started = true;
+                m->speed = mirror_speed;
+            }
+
+            if (!m->started)
+                pending += m->size;
+            else if (!m->ready)
+                active++;
+
+            remaining += m->remaining;
+            done += m->done;
         }
-    }
 
-    while ((rv = qemuMigrationSrcNBDStorageCopyReady(vm, VIR_ASYNC_JOB_MIGRATION_OUT)) != 1) {
-        if (rv < 0)
+        /* Balance even when all mirrors are ready so that the last ones
+         * to become ready get their full speed back */
+        if (qemuMigrationSrcNBDMirrorsBalance(vm, mirrors, nmirrors,
+                                              mirror_speed) < 0)
+            return -1;
+
+        if (active == 0 && pending == 0)
+            break;
+
+        if (virTimeMillisNow(&now) < 0)
             return -1;
 
+        /* Estimate the time needed to finish the initial copy of all disks
+         * from the average throughput so far. */
+        mirrorStats->pending = pending;
+        mirrorStats->timeRemaining = 0;
+        if (done > 0 && now > start)
+            mirrorStats->timeRemaining = (double) remaining * (now - start) / done;
+
         if (vm->job->abortJob) {
             vm->job->current->status = VIR_DOMAIN_JOB_STATUS_CANCELED;
             virReportError(VIR_ERR_OPERATION_ABORTED, _("%s: %s"),
@@ -1244,10 +1627,13 @@ qemuMigrationSrcNBDStorageCopy(virQEMUDriver *driver,
             return -1;
         }
 
-        if (qemuDomainObjWait(vm) < 0)
+        if (qemuDomainObjWaitUntil(vm, now + QEMU_MIGRATION_MIRROR_BALANCE_INTERVAL) < 0)
             return -1;
     }
 
+    mirrorStats->pending = 0;
+    mirrorStats->timeRemaining = 0;
+
     qemuMigrationSrcFetchMirrorStats(vm, VIR_ASYNC_JOB_MIGRATION_OUT,
                                      vm->job->current);
     return 0;
@@ -1907,6 +2293,7 @@ enum qemuMigrationCompletedFlags {
     QEMU_MIGRATION_COMPLETED_CHECK_STORAGE  = (1 << 1),
     QEMU_MIGRATION_COMPLETED_POSTCOPY       = (1 << 2),
     QEMU_MIGRATION_COMPLETED_PRE_SWITCHOVER = (1 << 3),
+    QEMU_MIGRATION_COMPLETED_AUTO_TUNE      = (1 << 4),
 };
 
 
@@ -2004,6 +2391,172 @@ qemuMigrationAnyCompleted(virDomainObj *vm,
 }
 
 
+/* How often the migration progress is sampled by the auto tuning code */
+#define QEMU_MIGRATION_AUTO_TUNE_INTERVAL 1000
+/* Highest downtime limit (in ms) the auto tuning code is allowed to set */
+#define QEMU_MIGRATION_AUTO_TUNE_DOWNTIME_MAX 2000
+/* Non-converging iterations to wait for before switching to post-copy */
+#define QEMU_MIGRATION_AUTO_TUNE_POSTCOPY_DELAY 3
+
+typedef struct _qemuMigrationAutoTune qemuMigrationAutoTune;
+struct _qemuMigrationAutoTune {
+    unsigned long long next;       /* when to take the next sample */
+    unsigned long long iteration;  /* last RAM iteration evaluated */
+    unsigned long long downtime;   /* current downtime limit in ms */
+    unsigned int stalled;          /* iterations without convergence */
+    bool postcopy;                 /* switch to post-copy was requested */
+};
+
+
+/**
+ * qemuMigrationSrcAutoTune:
+ * @vm: domain object
+ * @asyncJob: migration job
+ * @tune: state of the tuning
+ * @flags: qemuMigrationCompletedFlags
+ *
+ * Compares the rate at which the guest dirties its memory with the
+ * transfer bandwidth once per RAM iteration. If the migration does not
+ * converge, the downtime limit is raised to the expected downtime as long
+ * as it stays within QEMU_MIGRATION_AUTO_TUNE_DOWNTIME_MAX. If that is not
+ * enough and post-copy is enabled, the migration is switched to post-copy.
+ *
+ * Returns 0 on success, -1 on error.
+ */
+static int
+qemuMigrationSrcAutoTune(virDomainObj *vm,
+                         virDomainAsyncJob asyncJob,
+                         qemuMigrationAutoTune *tune,
+                         unsigned int flags)
+{
+    qemuDomainObjPrivate *priv = vm->privateData;
+    virDomainJobData *jobData = vm->job->current;
+    qemuDomainJobDataPrivate *privJob = jobData->privateData;
+    qemuMonitorMigrationStats *stats = &privJob->stats.mig;
+    g_autoptr(qemuMigrationParams) migParams = NULL;
+    unsigned long long dirtyRate;
+    unsigned long long expected;
+    int rc;
+
+    if (jobData->status != VIR_DOMAIN_JOB_STATUS_MIGRATING)
+        return 0;
+
+    if (qemuMigrationAnyFetchStats(vm, asyncJob, jobData, NULL) < 0)
+        return -1;
+
+    /* The first iteration copies all memory, there's nothing to predict
+     * until we know how much of it got dirty again. */
+    if (stats->ram_iteration < 2 || stats->ram_iteration == tune->iteration ||
+        stats->ram_bps == 0)
+        return 0;
+    tune->iteration = stats->ram_iteration;
+
+    if (tune->downtime == 0) {
+        if (qemuMigrationParamsFetch(vm, asyncJob, &migParams) < 0 ||
+            qemuMigrationParamsGetULL(migParams,
+                                      QEMU_MIGRATION_PARAM_DOWNTIME_LIMIT,
+                                      &tune->downtime) < 0)
+            return -1;
+        g_clear_pointer(&migParams, qemuMigrationParamsFree);
+    }
+
+    dirtyRate = stats->ram_dirty_rate * stats->ram_page_size;
+    expected = stats->ram_remaining * 1000 / stats->ram_bps;
+
+    VIR_DEBUG("iteration=%llu remaining=%llu bps=%llu dirty=%llu "
+              "expected downtime=%llums limit=%llums",
+              stats->ram_iteration, stats->ram_remaining, stats->ram_bps,
+              dirtyRate, expected, tune->downtime);
+
+    if (dirtyRate < stats->ram_bps || expected <= tune->downtime) {
+        tune->stalled = 0;
+        return 0;
+    }
+
+    tune->stalled++;
+
+    if (expected <= QEMU_MIGRATION_AUTO_TUNE_DOWNTIME_MAX) {
+        /* leave some margin for the dirty rate growing further */
+        tune->downtime = MIN(expected + expected / 10,
+                             QEMU_MIGRATION_AUTO_TUNE_DOWNTIME_MAX);
+
+        qemuDomainLogAppendMessage(priv->driver, vm,
+                                   "migration auto-tune: iteration %llu, "
+                                   "dirty rate %llu B/s exceeds bandwidth "
+                                   "%llu B/s, raising downtime limit to %llums\n",
+                                   stats->ram_iteration, dirtyRate,
+                                   stats->ram_bps, tune->downtime);
+
+        if (!(migParams = qemuMigrationParamsNew()) ||
+            qemuMigrationParamsSetULL(migParams,
+                                      QEMU_MIGRATION_PARAM_DOWNTIME_LIMIT,
+                                      tune->downtime) < 0 ||
+            qemuMigrationParamsUpdate(vm, asyncJob, migParams) < 0)
+            return -1;
+
+        return 0;
+    }
+
+    if (!(flags & QEMU_MIGRATION_COMPLETED_POSTCOPY) || tune->postcopy ||
+        tune->stalled < QEMU_MIGRATION_AUTO_TUNE_POSTCOPY_DELAY)
+        return 0;
+
+    qemuDomainLogAppendMessage(priv->driver, vm,
+                               "migration auto-tune: iteration %llu, "
+                               "expected downtime %llums after %u "
+                               "non-converging iterations, switching to "
+                               "post-copy\n",
+                               stats->ram_iteration, expected, tune->stalled);
+
+    if (qemuDomainObjEnterMonitorAsync(vm, asyncJob) < 0)
+        return -1;
+    rc = qemuMonitorMigrateStartPostCopy(priv->mon);
+    qemuDomainObjExitMonitor(vm);
+    if (rc < 0)
+        return -1;
+
+    tune->postcopy = true;
+    return 0;
+}
+
+
+/**
+ * qemuMigrationSrcAutoTuneWait:
+ * @vm: domain object
+ * @asyncJob: migration job
+ * @tune: state of the tuning
+ * @flags: qemuMigrationCompletedFlags
+ *
+ * Waits for the domain condition like qemuDomainObjWait, but wakes up
+ * periodically to let qemuMigrationSrcAutoTune evaluate the progress.
+ *
+ * Returns 0 on success, -1 on error.
+ */
+static int
+qemuMigrationSrcAutoTuneWait(virDomainObj *vm,
+                             virDomainAsyncJob asyncJob,
+                             qemuMigrationAutoTune *tune,
+                             unsigned int flags)
+{
+    unsigned long long now;
+
+    if (virTimeMillisNow(&now) < 0)
+        return -1;
+
+    if (now >= tune->next) {
+        if (tune->next > 0 &&
+            qemuMigrationSrcAutoTune(vm, asyncJob, tune, flags) < 0)
+            return -1;
+        tune->next = now + QEMU_MIGRATION_AUTO_TUNE_INTERVAL;
+    }
+
+    if (qemuDomainObjWaitUntil(vm, tune->next) < 0)
+        return -1;
+
+    return 0;
+}
+
+
 /* Returns 0 on success, -2 when migration needs to be cancelled, or -1 when
  * QEMU reports failed migration.
  */
@@ -2015,6 +2568,7 @@ qemuMigrationSrcWaitForCompletion(virDomainObj *vm,
 {
     qemuDomainObjPrivate *priv = vm->privateData;
     virDomainJobData *jobData = vm->job->current;
+    qemuMigrationAutoTune tune = { 0 };
     int rv;
 
     jobData->status = VIR_DOMAIN_JOB_STATUS_MIGRATING;
@@ -2023,7 +2577,12 @@ qemuMigrationSrcWaitForCompletion(virDomainObj *vm,
         if (rv < 0)
             return rv;
 
-        if (qemuDomainObjWait(vm) < 0) {
+        if (flags & QEMU_MIGRATION_COMPLETED_AUTO_TUNE)
+            rv = qemuMigrationSrcAutoTuneWait(vm, asyncJob, &tune, flags);
+        else
+            rv = qemuDomainObjWait(vm);
+
+        if (rv < 0) {
             if (virDomainObjIsActive(vm) && !priv->beingDestroyed)
                 jobData->status = VIR_DOMAIN_JOB_STATUS_FAILED;
             return -2;
@@ -2604,6 +3163,20 @@ qemuMigrationSrcBeginPhase(virQEMUDriver *driver,
         return NULL;
     }
 
+    if (flags & VIR_MIGRATE_POSTCOPY_PREEMPT) {
+        if (!(flags & VIR_MIGRATE_POSTCOPY)) {
+            virReportError(VIR_ERR_OPERATION_INVALID, "%s",
+                           _("post-copy preemption is only available for post-copy migration"));
+            return NULL;
+        }
+
+        if (flags & VIR_MIGRATE_TUNNELLED) {
+            virReportError(VIR_ERR_OPERATION_UNSUPPORTED, "%s",
+                           _("post-copy preemption is not supported with tunnelled migration"));
+            return NULL;
+        }
+    }
+
     if (flags & (VIR_MIGRATE_NON_SHARED_DISK | VIR_MIGRATE_NON_SHARED_INC)) {
         if (flags & VIR_MIGRATE_TUNNELLED) {
             virReportError(VIR_ERR_OPERATION_UNSUPPORTED, "%s",
@@ -3066,6 +3639,7 @@ qemuMigrationDstPrepareActive(virQEMUDriver *driver,
     unsigned int startFlags;
     bool relabel = false;
     bool tunnel = !!st;
+    unsigned long long phaseStart;
     int ret = -1;
     int rv;
 
@@ -3087,11 +3661,14 @@ qemuMigrationDstPrepareActive(virQEMUDriver *driver,
 
     startFlags = VIR_QEMU_PROCESS_START_AUTODESTROY;
 
+    phaseStart = g_get_monotonic_time();
     if (qemuProcessInit(driver, vm, mig->cpu, VIR_ASYNC_JOB_MIGRATION_IN,
                         true, startFlags) < 0)
         goto error;
     stopProcess = true;
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_INIT, &phaseStart);
+
     if (!(incoming = qemuMigrationDstPrepare(vm, tunnel, protocol,
                                              listenAddress, port,
                                              dataFD[0])))
@@ -3100,9 +3677,15 @@ qemuMigrationDstPrepareActive(virQEMUDriver *driver,
     if (qemuProcessPrepareDomain(driver, vm, startFlags) < 0)
         goto error;
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_PREPARE_DOMAIN,
+                              &phaseStart);
+
     if (qemuProcessPrepareHost(driver, vm, startFlags) < 0)
         goto error;
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_PREPARE_HOST,
+                              &phaseStart);
+
     rv = qemuProcessLaunch(dconn, driver, vm, VIR_ASYNC_JOB_MIGRATION_IN,
                            incoming, NULL,
                            VIR_NETDEV_VPORT_PROFILE_OP_MIGRATE_IN_START,
@@ -4916,6 +5499,8 @@ qemuMigrationSrcRun(virQEMUDriver *driver,
         waitFlags |= QEMU_MIGRATION_COMPLETED_CHECK_STORAGE;
     if (flags & VIR_MIGRATE_POSTCOPY)
         waitFlags |= QEMU_MIGRATION_COMPLETED_POSTCOPY;
+    if (flags & VIR_MIGRATE_AUTO_TUNE)
+        waitFlags |= QEMU_MIGRATION_COMPLETED_AUTO_TUNE;
 
     rc = qemuMigrationSrcWaitForCompletion(vm, VIR_ASYNC_JOB_MIGRATION_OUT,
                                            dconn, waitFlags);
@@ -6995,6 +7580,98 @@ qemuMigrationSrcToFile(virQEMUDriver *driver, virDomainObj *vm,
 }
 
 
+/**
+ * qemuMigrationSrcToSocket:
+ * @driver: qemu driver
+ * @vm: domain object
+ * @sockPath: UNIX socket the caller listens on
+ * @channels: number of multifd channels
+ * @asyncJob: async job
+ *
+ * Migrates the domain into @sockPath using @channels multifd connections on
+ * top of the main one. The caller is responsible for accepting all the
+ * connections and storing the data sent over them. Migration capabilities
+ * and parameters are reset once the migration is done.
+ */
+int
+qemuMigrationSrcToSocket(virQEMUDriver *driver,
+                         virDomainObj *vm,
+                         const char *sockPath,
+                         int channels,
+                         virDomainAsyncJob asyncJob)
+{
+    qemuDomainObjPrivate *priv = vm->privateData;
+    g_autoptr(qemuMigrationParams) migParams = NULL;
+    g_autoptr(qemuMigrationParams) origParams = NULL;
+    virErrorPtr orig_err = NULL;
+    int ret = -1;
+    int rc;
+
+    if (!qemuMigrationCapsGet(vm, QEMU_MIGRATION_CAP_MULTIFD)) {
+        virReportError(VIR_ERR_OPERATION_UNSUPPORTED, "%s",
+                       _("parallel save is not supported by this QEMU binary"));
+        return -1;
+    }
+
+    if (qemuMigrationSetDBusVMState(driver, vm) < 0)
+        return -1;
+
+    if (qemuMigrationParamsFetch(vm, asyncJob, &origParams) < 0)
+        return -1;
+
+    if (!(migParams = qemuMigrationParamsNew()))
+        return -1;
+
+    qemuMigrationParamsSetMultiFD(migParams, channels);
+
+    /* Target is a set of files, do not limit the bandwidth */
+    if (qemuMigrationParamsSetULL(migParams,
+                                  QEMU_MIGRATION_PARAM_MAX_BANDWIDTH,
+                                  QEMU_DOMAIN_MIG_BANDWIDTH_MAX * 1024 * 1024) < 0)
+        return -1;
+
+    if (qemuMigrationParamsApply(vm, asyncJob, migParams, 0) < 0)
+        goto cleanup;
+
+    if (!virDomainObjIsActive(vm)) {
+        virReportError(VIR_ERR_INTERNAL_ERROR, "%s",
+                       _("guest unexpectedly quit"));
+        goto cleanup;
+    }
+
+    if (qemuDomainObjEnterMonitorAsync(vm, asyncJob) < 0)
+        goto cleanup;
+
+    rc = qemuMonitorMigrateToSocket(priv->mon, 0, sockPath);
+    qemuDomainObjExitMonitor(vm);
+    if (rc < 0)
+        goto cleanup;
+
+    rc = qemuMigrationSrcWaitForCompletion(vm, asyncJob, NULL, 0);
+    if (rc < 0) {
+        if (rc == -2) {
+            virErrorPreserveLast(&orig_err);
+            if (virDomainObjIsActive(vm))
+                qemuMigrationSrcCancel(vm, asyncJob, true);
+        }
+        goto cleanup;
+    }
+
+    qemuDomainEventEmitJobCompleted(driver, vm);
+    ret = 0;
+
+ cleanup:
+    if (ret < 0 && !orig_err)
+        virErrorPreserveLast(&orig_err);
+
+    qemuMigrationParamsReset(vm, asyncJob, origParams, 0);
+
+    virErrorRestore(&orig_err);
+
+    return ret;
+}
+
+
 /**
  * This function is supposed to be used only to while reconnecting to a domain
  * with an active migration job.
@@ -7142,7 +7819,9 @@ qemuMigrationSrcFetchMirrorStats(virDomainObj *vm,
     if (!blockinfo)
         return -1;
 
-    memset(stats, 0, sizeof(*stats));
+    /* disks which were not started yet still need to be copied */
+    stats->transferred = 0;
+    stats->total = stats->pending;
 
     for (i = 0; i < vm->def->ndisks; i++) {
         virDomainDiskDef *disk = vm->def->disks[i];
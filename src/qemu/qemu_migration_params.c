@@ -95,6 +95,7 @@ VIR_ENUM_IMPL(qemuMigrationCapability,
               "dirty-bitmaps",
               "return-path",
               "zero-copy-send",
+              "postcopy-preempt",
 );
 
 
@@ -187,6 +188,11 @@ static const qemuMigrationParamsFlagMapItem qemuMigrationParamsFlagMap[] = {
      VIR_MIGRATE_ZEROCOPY,
      QEMU_MIGRATION_CAP_ZERO_COPY_SEND,
      QEMU_MIGRATION_SOURCE},
+
+    {QEMU_MIGRATION_FLAG_REQUIRED,
+     VIR_MIGRATE_POSTCOPY_PREEMPT,
+     QEMU_MIGRATION_CAP_POSTCOPY_PREEMPT,
+     QEMU_MIGRATION_SOURCE | QEMU_MIGRATION_DESTINATION},
 };
 
 /* Translation from VIR_MIGRATE_PARAM_* typed parameters to
@@ -955,6 +961,36 @@ qemuMigrationParamsApply(virDomainObj *vm,
 }
 
 
+/**
+ * qemuMigrationParamsUpdate:
+ * @vm: domain object
+ * @asyncJob: migration job
+ * @migParams: migration parameters to send to QEMU
+ *
+ * Send parameter values stored in @migParams to QEMU while migration is
+ * already running. Unlike qemuMigrationParamsApply, capabilities are left
+ * untouched since QEMU does not allow changing them at this point.
+ *
+ * Returns 0 on success, -1 on failure.
+ */
+int
+qemuMigrationParamsUpdate(virDomainObj *vm,
+                          int asyncJob,
+                          qemuMigrationParams *migParams)
+{
+    int ret;
+
+    if (qemuDomainObjEnterMonitorAsync(vm, asyncJob) < 0)
+        return -1;
+
+    ret = qemuMigrationParamsApplyValues(vm, migParams, false);
+
+    qemuDomainObjExitMonitor(vm);
+
+    return ret;
+}
+
+
 /**
  * qemuMigrationParamsSetString:
  * @migrParams: migration parameter object
@@ -1177,6 +1213,25 @@ qemuMigrationParamsSetULL(qemuMigrationParams *migParams,
 }
 
 
+/**
+ * qemuMigrationParamsSetMultiFD:
+ * @migParams: migration parameter object
+ * @channels: number of multifd channels
+ *
+ * Enables the multifd migration capability in @migParams and sets the number
+ * of channels QEMU should use for it.
+ */
+void
+qemuMigrationParamsSetMultiFD(qemuMigrationParams *migParams,
+                              int channels)
+{
+    ignore_value(virBitmapSetBit(migParams->caps, QEMU_MIGRATION_CAP_MULTIFD));
+
+    migParams->params[QEMU_MIGRATION_PARAM_MULTIFD_CHANNELS].value.i = channels;
+    migParams->params[QEMU_MIGRATION_PARAM_MULTIFD_CHANNELS].set = true;
+}
+
+
 /**
  * Returns -1 on error,
  *          0 on success,
@@ -40,6 +40,7 @@ typedef enum {
     QEMU_MIGRATION_CAP_BLOCK_DIRTY_BITMAPS,
     QEMU_MIGRATION_CAP_RETURN_PATH,
     QEMU_MIGRATION_CAP_ZERO_COPY_SEND,
+    QEMU_MIGRATION_CAP_POSTCOPY_PREEMPT,
 
     QEMU_MIGRATION_CAP_LAST
 } qemuMigrationCapability;
@@ -100,6 +101,11 @@ qemuMigrationParamsApply(virDomainObj *vm,
                          qemuMigrationParams *migParams,
                          unsigned int apiFlags);
 
+int
+qemuMigrationParamsUpdate(virDomainObj *vm,
+                          int asyncJob,
+                          qemuMigrationParams *migParams);
+
 int
 qemuMigrationParamsEnableTLS(virQEMUDriver *driver,
                              virDomainObj *vm,
@@ -126,6 +132,10 @@ qemuMigrationParamsSetULL(qemuMigrationParams *migParams,
                           qemuMigrationParam param,
                           unsigned long long value);
 
+void
+qemuMigrationParamsSetMultiFD(qemuMigrationParams *migParams,
+                              int channels);
+
 int
 qemuMigrationParamsGetULL(qemuMigrationParams *migParams,
                           qemuMigrationParam param,
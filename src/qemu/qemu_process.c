@@ -5697,6 +5697,8 @@ qemuProcessInit(virQEMUDriver *driver,
         goto cleanup;
     }
 
+    qemuDomainStartupPhasesReset(vm);
+
     /* in case when the post parse callback failed we need to re-run it on the
      * old config prior we start the VM */
     if (vm->def->postParseFailed) {
@@ -7621,6 +7623,7 @@ qemuProcessLaunch(virConnectPtr conn,
     g_autofree int *nicindexes = NULL;
     unsigned long long maxMemLock = 0;
     bool incomingMigrationExtDevices = false;
+    unsigned long long phaseStart = g_get_monotonic_time();
 
     VIR_DEBUG("conn=%p driver=%p vm=%p name=%s id=%d asyncJob=%d "
               "incoming.uri=%s "
@@ -7684,6 +7687,9 @@ qemuProcessLaunch(virConnectPtr conn,
     if (qemuExtDevicesStart(driver, vm, incomingMigrationExtDevices) < 0)
         goto cleanup;
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_EXT_DEVICES,
+                              &phaseStart);
+
     if (!(cmd = qemuBuildCommandLine(vm,
                                      incoming ? "defer" : NULL,
                                      snapshot, vmop,
@@ -7750,6 +7756,9 @@ qemuProcessLaunch(virConnectPtr conn,
     virCommandDaemonize(cmd);
     virCommandRequireHandshake(cmd);
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_COMMAND_LINE,
+                              &phaseStart);
+
     if (qemuSecurityPreFork(driver->securityManager) < 0)
         goto cleanup;
     rv = virCommandRun(cmd, NULL);
@@ -7783,14 +7792,23 @@ qemuProcessLaunch(virConnectPtr conn,
         goto cleanup;
     }
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_SPAWN,
+                              &phaseStart);
+
     VIR_DEBUG("Building domain mount namespace (if required)");
     if (qemuDomainBuildNamespace(cfg, vm) < 0)
         goto cleanup;
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_NAMESPACE,
+                              &phaseStart);
+
     VIR_DEBUG("Setting up domain cgroup (if required)");
     if (qemuSetupCgroup(vm, nnicindexes, nicindexes) < 0)
         goto cleanup;
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_CGROUP,
+                              &phaseStart);
+
     VIR_DEBUG("Setting up domain perf (if required)");
     if (qemuProcessEnablePerf(vm) < 0)
         goto cleanup;
@@ -7817,6 +7835,9 @@ qemuProcessLaunch(virConnectPtr conn,
         qemuProcessStartManagedPRDaemon(vm) < 0)
         goto cleanup;
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_HOST_TUNING,
+                              &phaseStart);
+
     VIR_DEBUG("Setting domain security labels");
     if (qemuSecuritySetAllLabel(driver,
                                 vm,
@@ -7849,6 +7870,9 @@ qemuProcessLaunch(virConnectPtr conn,
             goto cleanup;
     }
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_SECURITY_LABEL,
+                              &phaseStart);
+
     VIR_DEBUG("Labelling done, completing handshake to child");
     if (virCommandHandshakeNotify(cmd) < 0)
         goto cleanup;
@@ -7864,6 +7888,9 @@ qemuProcessLaunch(virConnectPtr conn,
     if (qemuConnectAgent(driver, vm) < 0)
         goto cleanup;
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_MONITOR,
+                              &phaseStart);
+
     VIR_DEBUG("setting up hotpluggable cpus");
     if (qemuDomainHasHotpluggableStartupVcpus(vm->def)) {
         if (qemuDomainRefreshVcpuInfo(vm, asyncJob, false) < 0)
@@ -7912,6 +7939,9 @@ qemuProcessLaunch(virConnectPtr conn,
                                vm->def->cputune.emulatorsched->priority) < 0)
         goto cleanup;
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_VCPUS,
+                              &phaseStart);
+
     VIR_DEBUG("Setting any required VM passwords");
     if (qemuProcessInitPasswords(driver, vm, asyncJob) < 0)
         goto cleanup;
@@ -7953,6 +7983,9 @@ qemuProcessLaunch(virConnectPtr conn,
     if (qemuProcessDeleteThreadContextHelper(vm, asyncJob) < 0)
         goto cleanup;
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_DEVICES,
+                              &phaseStart);
+
     ret = 0;
 
  cleanup:
@@ -8034,6 +8067,7 @@ qemuProcessFinishStartup(virQEMUDriver *driver,
                          virDomainPausedReason pausedReason)
 {
     g_autoptr(virQEMUDriverConfig) cfg = virQEMUDriverGetConfig(driver);
+    unsigned long long phaseStart = g_get_monotonic_time();
 
     if (startCPUs) {
         VIR_DEBUG("Starting domain CPUs");
@@ -8058,6 +8092,10 @@ qemuProcessFinishStartup(virQEMUDriver *driver,
                              VIR_HOOK_SUBOP_BEGIN) < 0)
         return -1;
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_FINISH,
+                              &phaseStart);
+    qemuDomainStartupPhasesLog(vm);
+
     return 0;
 }
 
@@ -8082,6 +8120,7 @@ qemuProcessStart(virConnectPtr conn,
     bool relabelSavedState = false;
     int ret = -1;
     int rv;
+    unsigned long long phaseStart = g_get_monotonic_time();
 
     VIR_DEBUG("conn=%p driver=%p vm=%p name=%s id=%d asyncJob=%s "
               "migrateFrom=%s migrateFd=%d migratePath=%s "
@@ -8104,6 +8143,8 @@ qemuProcessStart(virConnectPtr conn,
                         asyncJob, !!migrateFrom, flags) < 0)
         goto cleanup;
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_INIT, &phaseStart);
+
     if (migrateFrom) {
         incoming = qemuProcessIncomingDefNew(priv->qemuCaps, NULL, migrateFrom,
                                              migrateFd, migratePath);
@@ -8114,9 +8155,15 @@ qemuProcessStart(virConnectPtr conn,
     if (qemuProcessPrepareDomain(driver, vm, flags) < 0)
         goto stop;
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_PREPARE_DOMAIN,
+                              &phaseStart);
+
     if (qemuProcessPrepareHost(driver, vm, flags) < 0)
         goto stop;
 
+    qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_PREPARE_HOST,
+                              &phaseStart);
+
     if (migratePath) {
         if (qemuSecuritySetSavedStateLabel(driver->securityManager,
                                            vm->def, migratePath) < 0)
@@ -8132,15 +8179,22 @@ qemuProcessStart(virConnectPtr conn,
     }
     relabel = true;
 
+    phaseStart = g_get_monotonic_time();
     if (incoming) {
         if (qemuMigrationDstRun(vm, incoming->uri, asyncJob) < 0)
             goto stop;
+
+        qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_INCOMING,
+                                  &phaseStart);
     } else {
         /* Refresh state of devices from QEMU. During migration this happens
          * in qemuMigrationDstFinish to ensure that state information is fully
          * transferred. */
         if (qemuProcessRefreshState(driver, vm, asyncJob) < 0)
             goto stop;
+
+        qemuDomainStartupPhaseEnd(vm, QEMU_DOMAIN_STARTUP_PHASE_REFRESH_STATE,
+                                  &phaseStart);
     }
 
     if (qemuProcessFinishStartup(driver, vm, asyncJob,
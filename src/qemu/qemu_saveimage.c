@@ -28,10 +28,14 @@
 
 #include "virerror.h"
 #include "virlog.h"
+#include "virthread.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <fcntl.h>
+#include <poll.h>
 
 #define VIR_FROM_THIS VIR_FROM_QEMU
 
@@ -47,6 +51,7 @@ typedef enum {
      */
     QEMU_SAVE_FORMAT_XZ = 3,
     QEMU_SAVE_FORMAT_LZOP = 4,
+    QEMU_SAVE_FORMAT_ZSTD = 5,
     /* Note: add new members only at the end.
        These values are used in the on-disk format.
        Do not change or re-use numbers. */
@@ -62,6 +67,7 @@ VIR_ENUM_IMPL(qemuSaveCompression,
               "bzip2",
               "xz",
               "lzop",
+              "zstd",
 );
 
 static inline void
@@ -72,6 +78,7 @@ qemuSaveImageBswapHeader(virQEMUSaveHeader *hdr)
     hdr->was_running = GUINT32_SWAP_LE_BE(hdr->was_running);
     hdr->compressed = GUINT32_SWAP_LE_BE(hdr->compressed);
     hdr->cookieOffset = GUINT32_SWAP_LE_BE(hdr->cookieOffset);
+    hdr->multifd_channels = GUINT32_SWAP_LE_BE(hdr->multifd_channels);
 }
 
 
@@ -110,7 +117,7 @@ virQEMUSaveDataNew(char *domXML,
 
     header = &data->header;
     memcpy(header->magic, QEMU_SAVE_PARTIAL, sizeof(header->magic));
-    header->version = QEMU_SAVE_VERSION;
+    header->version = QEMU_SAVE_VERSION_SINGLE_STREAM;
     header->was_running = running ? 1 : 0;
     header->compressed = compressed;
 
@@ -123,6 +130,24 @@ virQEMUSaveDataNew(char *domXML,
 }
 
 
+/**
+ * virQEMUSaveDataSetChannels:
+ * @data: save data
+ * @channels: number of multifd channels
+ *
+ * Marks the image described by @data as a parallel one with @channels
+ * multifd channels stored in separate files next to the image.
+ */
+void
+virQEMUSaveDataSetChannels(virQEMUSaveData *data,
+                           unsigned int channels)
+{
+    data->header.multifd_channels = channels;
+    if (channels > 0)
+        data->header.version = QEMU_SAVE_VERSION;
+}
+
+
 /* virQEMUSaveDataWrite:
  *
  * Writes libvirt's header (including domain XML) into a saved image of a
@@ -243,7 +268,584 @@ qemuSaveImageGetCompressionCommand(virQEMUSaveFormat compression)
     if (compression == QEMU_SAVE_FORMAT_LZOP)
         virCommandAddArg(ret, "--ignore-warn");
 
+    if (compression == QEMU_SAVE_FORMAT_ZSTD)
+        virCommandAddArg(ret, "-q");
+
+    return ret;
+}
+
+
+/*
+ * Parallel save images keep the main migration stream in the image file
+ * itself, right after the header, while each multifd channel is stored in a
+ * separate file named after the image with a ".N" suffix. QEMU transfers
+ * the channels over a UNIX socket and libvirt moves the data between the
+ * socket connections and the files, one thread per channel.
+ */
+
+/* How long to wait for QEMU to start listening on restore */
+#define QEMU_SAVE_MULTIFD_CONNECT_TIMEOUT 30
+
+#define QEMU_SAVE_MULTIFD_BUF_SIZE (1024 * 1024)
+
+typedef struct _qemuSaveImageMultiFD qemuSaveImageMultiFD;
+
+typedef struct _qemuSaveImageChannel qemuSaveImageChannel;
+struct _qemuSaveImageChannel {
+    qemuSaveImageMultiFD *mfd;
+    char *path;     /* NULL for the main channel whose fd is not ours */
+    int fd;
+    virFileWrapperFd *wrapperFd;
+    bool needUnlink;
+    int sock;
+    virThread thread;
+    bool running;
+    virErrorPtr err;
+};
+
+struct _qemuSaveImageMultiFD {
+    bool save;      /* data flows from QEMU into the files */
+    char *sockPath;
+    int listenSock;
+    size_t nchannels;   /* including the main channel at index 0 */
+    qemuSaveImageChannel *channels;
+    virThread thread;   /* establishes connections and starts channels */
+    bool running;
+    virErrorPtr err;
+    int quit;
+};
+
+
+static char *
+qemuSaveImageChannelPath(const char *path,
+                         size_t idx)
+{
+    return g_strdup_printf("%s.%zu", path, idx);
+}
+
+
+/**
+ * qemuSaveImageUnlink:
+ * @path: path of the save image
+ *
+ * Removes the save image at @path along with any multifd channel files
+ * stored next to it.
+ *
+ * Returns the result of unlink() on @path.
+ */
+int
+qemuSaveImageUnlink(const char *path)
+{
+    size_t i;
+    int ret;
+
+    if ((ret = unlink(path)) < 0)
+        return ret;
+
+    for (i = 1; ; i++) {
+        g_autofree char *chanPath = qemuSaveImageChannelPath(path, i);
+
+        if (unlink(chanPath) < 0) {
+            if (errno != ENOENT)
+                VIR_WARN("Failed to remove save image channel '%s'", chanPath);
+            break;
+        }
+    }
+
+    return ret;
+}
+
+
+static qemuSaveImageMultiFD *
+qemuSaveImageMultiFDNew(bool save,
+                        int mainfd,
+                        size_t channels)
+{
+    qemuSaveImageMultiFD *mfd = g_new0(qemuSaveImageMultiFD, 1);
+    size_t i;
+
+    mfd->save = save;
+    mfd->listenSock = -1;
+    mfd->nchannels = channels + 1;
+    mfd->channels = g_new0(qemuSaveImageChannel, mfd->nchannels);
+
+    for (i = 0; i < mfd->nchannels; i++) {
+        mfd->channels[i].mfd = mfd;
+        mfd->channels[i].fd = -1;
+        mfd->channels[i].sock = -1;
+    }
+    mfd->channels[0].fd = mainfd;
+
+    return mfd;
+}
+
+
+static void
+qemuSaveImageMultiFDFree(qemuSaveImageMultiFD *mfd)
+{
+    size_t i;
+
+    if (!mfd)
+        return;
+
+    for (i = 0; i < mfd->nchannels; i++) {
+        qemuSaveImageChannel *chan = &mfd->channels[i];
+
+        VIR_FORCE_CLOSE(chan->sock);
+        if (chan->path) {
+            VIR_FORCE_CLOSE(chan->fd);
+            virFileWrapperFdFree(chan->wrapperFd);
+            if (chan->needUnlink)
+                unlink(chan->path);
+        }
+        virFreeError(chan->err);
+        g_free(chan->path);
+    }
+
+    VIR_FORCE_CLOSE(mfd->listenSock);
+    if (mfd->sockPath)
+        unlink(mfd->sockPath);
+
+    virFreeError(mfd->err);
+    g_free(mfd->channels);
+    g_free(mfd->sockPath);
+    g_free(mfd);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(qemuSaveImageMultiFD, qemuSaveImageMultiFDFree);
+
+
+static int
+qemuSaveImageMultiFDSockAddr(qemuSaveImageMultiFD *mfd,
+                             struct sockaddr_un *addr)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+
+    if (virStrcpyStatic(addr->sun_path, mfd->sockPath) < 0) {
+        virReportError(VIR_ERR_INTERNAL_ERROR,
+                       _("UNIX socket path '%s' too long"), mfd->sockPath);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+static void
+qemuSaveImageChannelCopy(void *opaque)
+{
+    qemuSaveImageChannel *chan = opaque;
+    g_autofree char *buf = g_new0(char, QEMU_SAVE_MULTIFD_BUF_SIZE);
+    int src = chan->mfd->save ? chan->sock : chan->fd;
+    int dst = chan->mfd->save ? chan->fd : chan->sock;
+    const char *what = chan->path ? chan->path : "main image";
+    unsigned long long total = 0;
+
+    while (1) {
+        ssize_t got = saferead(src, buf, QEMU_SAVE_MULTIFD_BUF_SIZE);
+
+        if (got < 0) {
+            virReportSystemError(errno, _("Unable to read save image channel '%s'"),
+                                 what);
+            break;
+        }
+
+        if (got == 0) {
+            /* Let QEMU know there is no more data in this channel */
+            if (!chan->mfd->save)
+                shutdown(chan->sock, SHUT_WR);
+            break;
+        }
+
+        if (safewrite(dst, buf, got) < 0) {
+            virReportSystemError(errno, _("Unable to write save image channel '%s'"),
+                                 what);
+            break;
+        }
+
+        total += got;
+    }
+
+    VIR_DEBUG("Transferred %llu bytes of save image channel '%s'", total, what);
+
+    virErrorPreserveLast(&chan->err);
+}
+
+
+static int
+qemuSaveImageMultiFDAccept(qemuSaveImageMultiFD *mfd,
+                           qemuSaveImageChannel *chan)
+{
+    while (!g_atomic_int_get(&mfd->quit)) {
+        struct pollfd pfd = { .fd = mfd->listenSock, .events = POLLIN };
+        int rc = poll(&pfd, 1, 100);
+
+        if (rc < 0 && errno != EINTR) {
+            virReportSystemError(errno, "%s",
+                                 _("Unable to wait for QEMU connection"));
+            return -1;
+        }
+        if (rc <= 0)
+            continue;
+
+        if ((chan->sock = accept(mfd->listenSock, NULL, NULL)) < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == ECONNABORTED)
+                continue;
+            virReportSystemError(errno, "%s",
+                                 _("Unable to accept QEMU connection"));
+            return -1;
+        }
+
+        return 0;
+    }
+
+    return -1;
+}
+
+
+static int
+qemuSaveImageMultiFDConnect(qemuSaveImageMultiFD *mfd,
+                            qemuSaveImageChannel *chan)
+{
+    struct sockaddr_un addr;
+    unsigned long long deadline = g_get_monotonic_time() +
+        QEMU_SAVE_MULTIFD_CONNECT_TIMEOUT * G_USEC_PER_SEC;
+
+    if (qemuSaveImageMultiFDSockAddr(mfd, &addr) < 0)
+        return -1;
+
+    /* QEMU starts listening only once the incoming migration is started */
+    while (!g_atomic_int_get(&mfd->quit)) {
+        if ((chan->sock = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+            virReportSystemError(errno, "%s", _("Unable to create socket"));
+            return -1;
+        }
+
+        if (connect(chan->sock, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+            return 0;
+
+        if ((errno != ENOENT && errno != ECONNREFUSED) ||
+            g_get_monotonic_time() > deadline) {
+            virReportSystemError(errno, _("Unable to connect to '%s'"),
+                                 mfd->sockPath);
+            VIR_FORCE_CLOSE(chan->sock);
+            return -1;
+        }
+
+        VIR_FORCE_CLOSE(chan->sock);
+        g_usleep(10 * 1000);
+    }
+
+    return -1;
+}
+
+
+static void
+qemuSaveImageMultiFDDispatch(void *opaque)
+{
+    qemuSaveImageMultiFD *mfd = opaque;
+    size_t i;
+
+    /* QEMU expects the main channel to be connected first */
+    for (i = 0; i < mfd->nchannels; i++) {
+        qemuSaveImageChannel *chan = &mfd->channels[i];
+        int rc;
+
+        if (mfd->save)
+            rc = qemuSaveImageMultiFDAccept(mfd, chan);
+        else
+            rc = qemuSaveImageMultiFDConnect(mfd, chan);
+
+        if (rc < 0)
+            goto error;
+
+        VIR_DEBUG("Save image channel %zu connected", i);
+
+        if (virThreadCreateFull(&chan->thread, true, qemuSaveImageChannelCopy,
+                                "qemu-save-channel", false, chan) < 0) {
+            virReportSystemError(errno, "%s",
+                                 _("Unable to create save image channel thread"));
+            goto error;
+        }
+        chan->running = true;
+    }
+
+    return;
+
+ error:
+    virErrorPreserveLast(&mfd->err);
+}
+
+
+static int
+qemuSaveImageMultiFDStart(qemuSaveImageMultiFD *mfd)
+{
+    if (virThreadCreateFull(&mfd->thread, true, qemuSaveImageMultiFDDispatch,
+                            "qemu-save-multifd", false, mfd) < 0) {
+        virReportSystemError(errno, "%s",
+                             _("Unable to create save image dispatch thread"));
+        return -1;
+    }
+
+    mfd->running = true;
+    return 0;
+}
+
+
+/**
+ * qemuSaveImageMultiFDStop:
+ * @mfd: parallel save image state
+ * @cancel: the migration failed, interrupt any transfer in progress
+ *
+ * Waits for all channels to finish transferring data. When @cancel is true,
+ * the connections are torn down first and any error hit by the channels is
+ * ignored in favor of the one already reported by the caller.
+ *
+ * Returns 0 on success, -1 if any of the channels failed.
+ */
+static int
+qemuSaveImageMultiFDStop(qemuSaveImageMultiFD *mfd,
+                         bool cancel)
+{
+    virErrorPtr err = NULL;
+    size_t i;
+
+    if (cancel) {
+        g_atomic_int_set(&mfd->quit, 1);
+        virErrorPreserveLast(&err);
+    }
+
+    if (mfd->running) {
+        virThreadJoin(&mfd->thread);
+        mfd->running = false;
+    }
+
+    for (i = 0; i < mfd->nchannels; i++) {
+        qemuSaveImageChannel *chan = &mfd->channels[i];
+
+        if (cancel && chan->sock >= 0)
+            shutdown(chan->sock, SHUT_RDWR);
+
+        if (chan->running) {
+            virThreadJoin(&chan->thread);
+            chan->running = false;
+        }
+    }
+
+    if (cancel) {
+        virErrorRestore(&err);
+        return -1;
+    }
+
+    if (mfd->err) {
+        virErrorRestore(&mfd->err);
+        return -1;
+    }
+
+    for (i = 0; i < mfd->nchannels; i++) {
+        if (mfd->channels[i].err) {
+            virErrorRestore(&mfd->channels[i].err);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+/* Migrate the domain into a parallel save image whose header was already
+ * written to @fd. */
+static int
+qemuSaveImageCreateMultiFD(virQEMUDriver *driver,
+                           virDomainObj *vm,
+                           const char *path,
+                           int fd,
+                           unsigned int channels,
+                           int directFlag,
+                           virDomainAsyncJob asyncJob)
+{
+    g_autoptr(virQEMUDriverConfig) cfg = virQEMUDriverGetConfig(driver);
+    qemuDomainObjPrivate *priv = vm->privateData;
+    g_autoptr(qemuSaveImageMultiFD) mfd = NULL;
+    struct sockaddr_un addr;
+    int rc;
+    size_t i;
+
+    mfd = qemuSaveImageMultiFDNew(true, fd, channels);
+
+    for (i = 1; i < mfd->nchannels; i++) {
+        qemuSaveImageChannel *chan = &mfd->channels[i];
+
+        chan->path = qemuSaveImageChannelPath(path, i);
+        chan->fd = virQEMUFileOpenAs(cfg->user, cfg->group, false, chan->path,
+                                     O_WRONLY | O_TRUNC | O_CREAT | directFlag,
+                                     &chan->needUnlink);
+        if (chan->fd < 0)
+            return -1;
+
+        if (directFlag &&
+            !(chan->wrapperFd = virFileWrapperFdNew(&chan->fd, chan->path,
+                                                    VIR_FILE_WRAPPER_BYPASS_CACHE)))
+            return -1;
+    }
+
+    mfd->sockPath = g_strdup_printf("%s/save-multifd.sock", priv->libDir);
+
+    if (qemuSaveImageMultiFDSockAddr(mfd, &addr) < 0)
+        return -1;
+
+    if ((mfd->listenSock = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        virReportSystemError(errno, "%s", _("Unable to create socket"));
+        return -1;
+    }
+
+    if (unlink(mfd->sockPath) < 0 && errno != ENOENT) {
+        virReportSystemError(errno, _("Unable to remove stale socket '%s'"),
+                             mfd->sockPath);
+        return -1;
+    }
+
+    if (bind(mfd->listenSock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(mfd->listenSock, mfd->nchannels) < 0) {
+        virReportSystemError(errno, _("Unable to listen on '%s'"),
+                             mfd->sockPath);
+        return -1;
+    }
+
+    if (qemuSecurityDomainSetPathLabel(driver, vm, mfd->sockPath, false) < 0)
+        return -1;
+
+    if (qemuSaveImageMultiFDStart(mfd) < 0)
+        return -1;
+
+    rc = qemuMigrationSrcToSocket(driver, vm, mfd->sockPath, channels, asyncJob);
+
+    if (qemuSaveImageMultiFDStop(mfd, rc < 0) < 0)
+        return -1;
+
+    for (i = 1; i < mfd->nchannels; i++) {
+        qemuSaveImageChannel *chan = &mfd->channels[i];
+
+        if (VIR_CLOSE(chan->fd) < 0) {
+            virReportSystemError(errno, _("unable to close %s"), chan->path);
+            return -1;
+        }
+
+        if (qemuDomainFileWrapperFDClose(vm, chan->wrapperFd) < 0)
+            return -1;
+
+        chan->needUnlink = false;
+    }
+
+    return 0;
+}
+
+
+/* Start QEMU for restoring a parallel save image. Behaves like
+ * qemuProcessStart() with incoming migration, only the data is fed to QEMU
+ * over multiple connections to a UNIX socket. */
+static int
+qemuSaveImageStartProcessMultiFD(virConnectPtr conn,
+                                 virQEMUDriver *driver,
+                                 virDomainObj *vm,
+                                 virCPUDef *updatedCPU,
+                                 int fd,
+                                 const char *path,
+                                 unsigned int channels,
+                                 unsigned int flags,
+                                 virDomainAsyncJob asyncJob)
+{
+    g_autoptr(virQEMUDriverConfig) cfg = virQEMUDriverGetConfig(driver);
+    qemuDomainObjPrivate *priv = vm->privateData;
+    g_autoptr(qemuSaveImageMultiFD) mfd = NULL;
+    g_autoptr(qemuMigrationParams) migParams = NULL;
+    g_autoptr(qemuMigrationParams) origParams = NULL;
+    qemuProcessIncomingDef *incoming = NULL;
+    g_autofree char *uri = NULL;
+    unsigned int stopFlags = VIR_QEMU_PROCESS_STOP_MIGRATED;
+    bool relabel = false;
+    int ret = -1;
+    int rv;
+    size_t i;
+
+    mfd = qemuSaveImageMultiFDNew(false, fd, channels);
+
+    for (i = 1; i < mfd->nchannels; i++) {
+        qemuSaveImageChannel *chan = &mfd->channels[i];
+
+        chan->path = qemuSaveImageChannelPath(path, i);
+        if ((chan->fd = qemuDomainOpenFile(cfg, NULL, chan->path,
+                                           O_RDONLY, NULL)) < 0)
+            return -1;
+    }
+
+    if (qemuProcessInit(driver, vm, updatedCPU, asyncJob, true, flags) < 0)
+        return -1;
+
+    if (qemuProcessPrepareDomain(driver, vm, flags) < 0 ||
+        qemuProcessPrepareHost(driver, vm, flags) < 0)
+        goto stop;
+
+    mfd->sockPath = g_strdup_printf("%s/restore-multifd.sock", priv->libDir);
+    uri = g_strdup_printf("unix:%s", mfd->sockPath);
+
+    if (!(incoming = qemuProcessIncomingDefNew(priv->qemuCaps, NULL, uri,
+                                               -1, NULL)))
+        goto stop;
+
+    if ((rv = qemuProcessLaunch(conn, driver, vm, asyncJob, incoming, NULL,
+                                VIR_NETDEV_VPORT_PROFILE_OP_RESTORE,
+                                flags)) < 0) {
+        if (rv == -2)
+            relabel = true;
+        goto stop;
+    }
+    relabel = true;
+
+    if (!qemuMigrationCapsGet(vm, QEMU_MIGRATION_CAP_MULTIFD)) {
+        virReportError(VIR_ERR_OPERATION_UNSUPPORTED, "%s",
+                       _("restoring parallel save image is not supported by this QEMU binary"));
+        goto stop;
+    }
+
+    if (qemuMigrationParamsFetch(vm, asyncJob, &origParams) < 0)
+        goto stop;
+
+    if (!(migParams = qemuMigrationParamsNew()))
+        goto stop;
+
+    qemuMigrationParamsSetMultiFD(migParams, channels);
+
+    if (qemuMigrationParamsApply(vm, asyncJob, migParams, 0) < 0 ||
+        qemuSaveImageMultiFDStart(mfd) < 0)
+        goto stop;
+
+    rv = qemuMigrationDstRun(vm, incoming->uri, asyncJob);
+
+    if (qemuSaveImageMultiFDStop(mfd, rv < 0) < 0)
+        goto stop;
+
+    /* Do not let multifd leak into later save or migration jobs */
+    qemuMigrationParamsReset(vm, asyncJob, origParams, 0);
+
+    if (qemuProcessFinishStartup(driver, vm, asyncJob, false,
+                                 VIR_DOMAIN_PAUSED_MIGRATION) < 0)
+        goto stop;
+
+    ret = 0;
+
+ cleanup:
+    qemuProcessIncomingDefFree(incoming);
     return ret;
+
+ stop:
+    if (!relabel)
+        stopFlags |= VIR_QEMU_PROCESS_STOP_NO_RELABEL;
+    if (priv->mon)
+        qemuMonitorSetDomainLog(priv->mon, NULL, NULL, NULL);
+    qemuProcessStop(driver, vm, VIR_DOMAIN_SHUTOFF_FAILED, asyncJob, stopFlags);
+    goto cleanup;
 }
 
 
@@ -266,6 +868,13 @@ qemuSaveImageCreate(virQEMUDriver *driver,
     int directFlag = 0;
     virFileWrapperFd *wrapperFd = NULL;
     unsigned int wrapperFlags = VIR_FILE_WRAPPER_NON_BLOCKING;
+    unsigned int channels = data->header.multifd_channels;
+
+    if (channels > 0 && compressor) {
+        virReportError(VIR_ERR_OPERATION_UNSUPPORTED, "%s",
+                       _("parallel save is not supported with compressed images"));
+        return -1;
+    }
 
     /* Obtain the file handle.  */
     if ((flags & VIR_DOMAIN_SAVE_BYPASS_CACHE)) {
@@ -294,8 +903,14 @@ qemuSaveImageCreate(virQEMUDriver *driver,
         goto cleanup;
 
     /* Perform the migration */
-    if (qemuMigrationSrcToFile(driver, vm, fd, compressor, asyncJob) < 0)
-        goto cleanup;
+    if (channels > 0) {
+        if (qemuSaveImageCreateMultiFD(driver, vm, path, fd, channels,
+                                       directFlag, asyncJob) < 0)
+            goto cleanup;
+    } else {
+        if (qemuMigrationSrcToFile(driver, vm, fd, compressor, asyncJob) < 0)
+            goto cleanup;
+    }
 
     /* Touch up file header to mark image complete. */
 
@@ -331,6 +946,7 @@ qemuSaveImageCreate(virQEMUDriver *driver,
 
 
 /* qemuSaveImageGetCompressionProgram:
+ * @cfg: driver config providing the compression tuning knobs
  * @imageFormat: String representation from qemu.conf for the compression
  *               image format being used (dump, save, or snapshot).
  * @compresspath: Pointer to a character string to store the fully qualified
@@ -350,7 +966,8 @@ qemuSaveImageCreate(virQEMUDriver *driver,
  *                           indicating none.
  */
 int
-qemuSaveImageGetCompressionProgram(const char *imageFormat,
+qemuSaveImageGetCompressionProgram(virQEMUDriverConfig *cfg,
+                                   const char *imageFormat,
                                    virCommand **compressor,
                                    const char *styleFormat,
                                    bool use_raw_on_fail)
@@ -377,6 +994,15 @@ qemuSaveImageGetCompressionProgram(const char *imageFormat,
     if (ret == QEMU_SAVE_FORMAT_XZ)
         virCommandAddArg(*compressor, "-3");
 
+    if (ret == QEMU_SAVE_FORMAT_ZSTD) {
+        /* zstd compresses in worker threads on its own, -T0 means one
+         * worker per host CPU */
+        virCommandAddArg(*compressor, "-q");
+        virCommandAddArgFormat(*compressor, "-T%u", cfg->zstdCompressionThreads);
+        if (cfg->zstdCompressionLevel > 0)
+            virCommandAddArgFormat(*compressor, "-%u", cfg->zstdCompressionLevel);
+    }
+
     return ret;
 
  error:
@@ -521,6 +1147,21 @@ qemuSaveImageOpen(virQEMUDriver *driver,
         return -1;
     }
 
+    if (header->multifd_channels > 0 &&
+        header->version < QEMU_SAVE_VERSION) {
+        virReportError(VIR_ERR_OPERATION_FAILED,
+                       _("multifd channels are not supported by image version %d"),
+                       header->version);
+        return -1;
+    }
+
+    if (header->multifd_channels > QEMU_SAVE_MULTIFD_CHANNELS_MAX) {
+        virReportError(VIR_ERR_OPERATION_FAILED,
+                       _("invalid number of multifd channels: %u"),
+                       header->multifd_channels);
+        return -1;
+    }
+
     if (header->data_len <= 0) {
         virReportError(VIR_ERR_OPERATION_FAILED,
                        _("invalid header data length: %d"), header->data_len);
@@ -599,7 +1240,14 @@ qemuSaveImageStartVM(virConnectPtr conn,
                                  virDomainXMLOptionGetSaveCookie(driver->xmlopt)) < 0)
         goto cleanup;
 
-    if ((header->version == 2) &&
+    if (header->multifd_channels > 0 &&
+        header->compressed != QEMU_SAVE_FORMAT_RAW) {
+        virReportError(VIR_ERR_OPERATION_FAILED, "%s",
+                       _("compressed parallel save images are not supported"));
+        goto cleanup;
+    }
+
+    if ((header->version >= 2) &&
         (header->compressed != QEMU_SAVE_FORMAT_RAW)) {
         if (!(cmd = qemuSaveImageGetCompressionCommand(header->compressed)))
             goto cleanup;
@@ -629,11 +1277,19 @@ qemuSaveImageStartVM(virConnectPtr conn,
     if (cookie && !cookie->slirpHelper)
         priv->disableSlirp = true;
 
-    if (qemuProcessStart(conn, driver, vm, cookie ? cookie->cpu : NULL,
-                         asyncJob, "stdio", *fd, path, NULL,
-                         VIR_NETDEV_VPORT_PROFILE_OP_RESTORE,
-                         start_flags) == 0)
+    if (header->multifd_channels > 0) {
+        if (qemuSaveImageStartProcessMultiFD(conn, driver, vm,
+                                             cookie ? cookie->cpu : NULL,
+                                             *fd, path,
+                                             header->multifd_channels,
+                                             start_flags, asyncJob) == 0)
+            started = true;
+    } else if (qemuProcessStart(conn, driver, vm, cookie ? cookie->cpu : NULL,
+                                asyncJob, "stdio", *fd, path, NULL,
+                                VIR_NETDEV_VPORT_PROFILE_OP_RESTORE,
+                                start_flags) == 0) {
         started = true;
+    }
 
     if (intermediatefd != -1) {
         virErrorPtr orig_err = NULL;
@@ -28,7 +28,14 @@
  */
 #define QEMU_SAVE_MAGIC   "LibvirtQemudSave"
 #define QEMU_SAVE_PARTIAL "LibvirtQemudPart"
-#define QEMU_SAVE_VERSION 2
+#define QEMU_SAVE_VERSION 3
+
+/* Images without multifd channels keep using version 2 so that they can
+ * still be restored by older releases */
+#define QEMU_SAVE_VERSION_SINGLE_STREAM 2
+
+/* Maximum number of multifd channels QEMU accepts */
+#define QEMU_SAVE_MULTIFD_CHANNELS_MAX 255
 
 G_STATIC_ASSERT(sizeof(QEMU_SAVE_MAGIC) == sizeof(QEMU_SAVE_PARTIAL));
 
@@ -40,7 +47,8 @@ struct _virQEMUSaveHeader {
     uint32_t was_running;
     uint32_t compressed;
     uint32_t cookieOffset;
-    uint32_t unused[14];
+    uint32_t multifd_channels;
+    uint32_t unused[13];
 };
 
 
@@ -82,11 +90,12 @@ qemuSaveImageOpen(virQEMUDriver *driver,
     ATTRIBUTE_NONNULL(3) ATTRIBUTE_NONNULL(4);
 
 int
-qemuSaveImageGetCompressionProgram(const char *imageFormat,
+qemuSaveImageGetCompressionProgram(virQEMUDriverConfig *cfg,
+                                   const char *imageFormat,
                                    virCommand **compressor,
                                    const char *styleFormat,
                                    bool use_raw_on_fail)
-    ATTRIBUTE_NONNULL(2);
+    ATTRIBUTE_NONNULL(1) ATTRIBUTE_NONNULL(3);
 
 int
 qemuSaveImageCreate(virQEMUDriver *driver,
@@ -109,5 +118,12 @@ virQEMUSaveDataNew(char *domXML,
                    int compressed,
                    virDomainXMLOption *xmlopt);
 
+void
+virQEMUSaveDataSetChannels(virQEMUSaveData *data,
+                           unsigned int channels);
+
 void
 virQEMUSaveDataFree(virQEMUSaveData *data);
+
+int
+qemuSaveImageUnlink(const char *path);
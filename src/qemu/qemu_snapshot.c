@@ -1327,7 +1327,8 @@ qemuSnapshotCreateActiveExternal(virQEMUDriver *driver,
                                           JOB_MASK(VIR_JOB_SUSPEND) |
                                           JOB_MASK(VIR_JOB_MIGRATION_OP)));
 
-        if ((compressed = qemuSaveImageGetCompressionProgram(cfg->snapshotImageFormat,
+        if ((compressed = qemuSaveImageGetCompressionProgram(cfg,
+                                                             cfg->snapshotImageFormat,
                                                              &compressor,
                                                              "snapshot", false)) < 0)
             goto cleanup;
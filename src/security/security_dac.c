@@ -109,6 +109,28 @@ virSecurityDACChownListAppend(virSecurityDACChownList *list,
                               bool restore)
 {
     g_autoptr(virSecurityDACChownItem) item = NULL;
+    size_t i;
+
+    /* Backing chains shared between disks and similar setups make the same
+     * path to be relabelled multiple times. Skip the item if the last queued
+     * operation on the path is identical, unless the original owner is
+     * remembered as that is reference counted. */
+    for (i = list->nItems; i > 0; i--) {
+        virSecurityDACChownItem *tmp = list->items[i - 1];
+
+        if (STRNEQ_NULLABLE(tmp->path, path) ||
+            (!path && tmp->src != src))
+            continue;
+
+        if (!remember && !tmp->remember &&
+            tmp->restore == restore &&
+            tmp->uid == uid && tmp->gid == gid) {
+            VIR_DEBUG("Skipping duplicate relabel of '%s'", NULLSTR(path));
+            return 0;
+        }
+
+        break;
+    }
 
     item = g_new0(virSecurityDACChownItem, 1);
 
@@ -193,6 +215,32 @@ static int virSecurityDACRestoreFileLabelInternal(virSecurityManager *mgr,
                                                   const virStorageSource *src,
                                                   const char *path,
                                                   bool recall);
+
+
+static int
+virSecurityDACTransactionRunItem(size_t idx,
+                                 void *opaque)
+{
+    virSecurityDACChownList *list = opaque;
+    virSecurityDACChownItem *item = list->items[idx];
+    const bool remember = item->remember && list->lock;
+
+    if (!item->restore) {
+        return virSecurityDACSetOwnership(list->manager,
+                                          item->src,
+                                          item->path,
+                                          item->uid,
+                                          item->gid,
+                                          remember);
+    }
+
+    return virSecurityDACRestoreFileLabelInternal(list->manager,
+                                                  item->src,
+                                                  item->path,
+                                                  remember);
+}
+
+
 /**
  * virSecurityDACTransactionRun:
  * @pid: process pid
@@ -201,7 +249,8 @@ static int virSecurityDACRestoreFileLabelInternal(virSecurityManager *mgr,
  * This is the callback that runs in the same namespace as the domain we are
  * relabelling. For given transaction (@opaque) it relabels all the paths on
  * the list. Depending on security manager configuration it might lock paths
- * we will relabel.
+ * we will relabel. Distinct paths are relabelled concurrently, see
+ * virSecurityRelabelParallel().
  *
  * Returns: 0 on success
  *         -1 otherwise.
@@ -213,6 +262,8 @@ virSecurityDACTransactionRun(pid_t pid G_GNUC_UNUSED,
     virSecurityDACChownList *list = opaque;
     virSecurityManagerMetadataLockState *state;
     g_autofree const char **paths = NULL;
+    g_autofree const char **itemPaths = NULL;
+    g_autofree bool *done = NULL;
     size_t npaths = 0;
     size_t i;
     int rv = 0;
@@ -246,32 +297,28 @@ virSecurityDACTransactionRun(pid_t pid G_GNUC_UNUSED,
         }
     }
 
+    itemPaths = g_new0(const char *, list->nItems);
+    done = g_new0(bool, list->nItems);
+
     for (i = 0; i < list->nItems; i++) {
         virSecurityDACChownItem *item = list->items[i];
-        const bool remember = item->remember && list->lock;
 
-        if (!item->restore) {
-            rv = virSecurityDACSetOwnership(list->manager,
-                                            item->src,
-                                            item->path,
-                                            item->uid,
-                                            item->gid,
-                                            remember);
-        } else {
-            rv = virSecurityDACRestoreFileLabelInternal(list->manager,
-                                                        item->src,
-                                                        item->path,
-                                                        remember);
-        }
-
-        if (rv < 0)
-            break;
+        itemPaths[i] = item->path;
+        if (!itemPaths[i] && item->src)
+            itemPaths[i] = item->src->path;
     }
 
-    for (; rv < 0 && i > 0; i--) {
+    rv = virSecurityRelabelParallel(itemPaths, list->nItems,
+                                    virSecurityDACTransactionRunItem,
+                                    list, done);
+
+    for (i = list->nItems; rv < 0 && i > 0; i--) {
         virSecurityDACChownItem *item = list->items[i - 1];
         const bool remember = item->remember && list->lock;
 
+        if (!done[i - 1])
+            continue;
+
         if (!item->restore) {
             virSecurityDACRestoreFileLabelInternal(list->manager,
                                                    item->src,
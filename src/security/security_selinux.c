@@ -113,6 +113,27 @@ virSecuritySELinuxContextListAppend(virSecuritySELinuxContextList *list,
                                     bool restore)
 {
     virSecuritySELinuxContextItem *item = NULL;
+    size_t i;
+
+    /* Backing chains shared between disks and similar setups make the same
+     * path to be relabelled multiple times. Skip the item if the last queued
+     * operation on the path is identical, unless the original label is
+     * remembered as that is reference counted. */
+    for (i = list->nItems; i > 0; i--) {
+        virSecuritySELinuxContextItem *tmp = list->items[i - 1];
+
+        if (STRNEQ(tmp->path, path))
+            continue;
+
+        if (!remember && !tmp->remember &&
+            tmp->restore == restore &&
+            STREQ_NULLABLE(tmp->tcon, tcon)) {
+            VIR_DEBUG("Skipping duplicate relabel of '%s'", path);
+            return 0;
+        }
+
+        break;
+    }
 
     item = g_new0(virSecuritySELinuxContextItem, 1);
 
@@ -219,6 +240,27 @@ static int virSecuritySELinuxRestoreFileLabel(virSecurityManager *mgr,
                                               bool recall);
 
 
+static int
+virSecuritySELinuxTransactionRunItem(size_t idx,
+                                     void *opaque)
+{
+    virSecuritySELinuxContextList *list = opaque;
+    virSecuritySELinuxContextItem *item = list->items[idx];
+    const bool remember = item->remember && list->lock;
+
+    if (!item->restore) {
+        return virSecuritySELinuxSetFilecon(list->manager,
+                                            item->path,
+                                            item->tcon,
+                                            remember);
+    }
+
+    return virSecuritySELinuxRestoreFileLabel(list->manager,
+                                              item->path,
+                                              remember);
+}
+
+
 /**
  * virSecuritySELinuxTransactionRun:
  * @pid: process pid
@@ -226,7 +268,8 @@ static int virSecuritySELinuxRestoreFileLabel(virSecurityManager *mgr,
  *
  * This is the callback that runs in the same namespace as the domain we are
  * relabelling. For given transaction (@opaque) it relabels all the paths on
- * the list.
+ * the list. Distinct paths are relabelled concurrently, see
+ * virSecurityRelabelParallel().
  *
  * Returns: 0 on success
  *         -1 otherwise.
@@ -238,6 +281,8 @@ virSecuritySELinuxTransactionRun(pid_t pid G_GNUC_UNUSED,
     virSecuritySELinuxContextList *list = opaque;
     virSecurityManagerMetadataLockState *state;
     const char **paths = NULL;
+    g_autofree const char **itemPaths = NULL;
+    g_autofree bool *done = NULL;
     size_t npaths = 0;
     size_t i;
     int rv;
@@ -272,30 +317,23 @@ virSecuritySELinuxTransactionRun(pid_t pid G_GNUC_UNUSED,
         }
     }
 
-    rv = 0;
-    for (i = 0; i < list->nItems; i++) {
-        virSecuritySELinuxContextItem *item = list->items[i];
-        const bool remember = item->remember && list->lock;
+    itemPaths = g_new0(const char *, list->nItems);
+    done = g_new0(bool, list->nItems);
 
-        if (!item->restore) {
-            rv = virSecuritySELinuxSetFilecon(list->manager,
-                                              item->path,
-                                              item->tcon,
-                                              remember);
-        } else {
-            rv = virSecuritySELinuxRestoreFileLabel(list->manager,
-                                                    item->path,
-                                                    remember);
-        }
+    for (i = 0; i < list->nItems; i++)
+        itemPaths[i] = list->items[i]->path;
 
-        if (rv < 0)
-            break;
-    }
+    rv = virSecurityRelabelParallel(itemPaths, list->nItems,
+                                    virSecuritySELinuxTransactionRunItem,
+                                    list, done);
 
-    for (; rv < 0 && i > 0; i--) {
+    for (i = list->nItems; rv < 0 && i > 0; i--) {
         virSecuritySELinuxContextItem *item = list->items[i - 1];
         const bool remember = item->remember && list->lock;
 
+        if (!done[i - 1])
+            continue;
+
         if (!item->restore) {
             virSecuritySELinuxRestoreFileLabel(list->manager,
                                                item->path,
@@ -24,6 +24,7 @@
 #include "virerror.h"
 #include "virlog.h"
 #include "virhostuptime.h"
+#include "virthread.h"
 
 #include "security_util.h"
 
@@ -544,3 +545,146 @@ virSecurityMoveRememberedLabel(const char *name,
 
     return 0;
 }
+
+
+/* Relabelling a handful of paths is not worth spawning threads for, so the
+ * number of workers grows with the number of paths up to a fixed limit. */
+#define VIR_SECURITY_RELABEL_PATHS_PER_WORKER 4
+#define VIR_SECURITY_RELABEL_WORKERS_MAX 8
+
+typedef struct _virSecurityRelabelWorker virSecurityRelabelWorker;
+struct _virSecurityRelabelWorker {
+    size_t id;
+    size_t nworkers;
+    const char **paths;
+    size_t npaths;
+    virSecurityRelabelFunc func;
+    void *opaque;
+    bool *done;
+    int *failed;
+
+    virThread thread;
+    bool running;
+    virErrorPtr err;
+};
+
+
+static void
+virSecurityRelabelWorkerRun(void *opaque)
+{
+    virSecurityRelabelWorker *worker = opaque;
+    size_t i;
+
+    for (i = 0; i < worker->npaths; i++) {
+        const char *path = worker->paths[i];
+        unsigned long long start;
+
+        /* All operations on a single path are handled by the same worker so
+         * that they are executed in the order they were requested in. */
+        if (worker->nworkers > 1 &&
+            (path ? g_str_hash(path) : 0) % worker->nworkers != worker->id)
+            continue;
+
+        if (g_atomic_int_get(worker->failed))
+            return;
+
+        start = g_get_monotonic_time();
+
+        if (worker->func(i, worker->opaque) < 0) {
+            virErrorPreserveLast(&worker->err);
+            g_atomic_int_set(worker->failed, 1);
+            return;
+        }
+
+        worker->done[i] = true;
+
+        VIR_DEBUG("relabelling '%s' took %lluus",
+                  NULLSTR(path), g_get_monotonic_time() - start);
+    }
+}
+
+
+/**
+ * virSecurityRelabelParallel:
+ * @paths: paths to be relabelled
+ * @npaths: number of items in @paths
+ * @func: callback relabelling single item
+ * @opaque: opaque data passed to @func
+ * @done: array of @npaths items
+ *
+ * Calls @func for every item of @paths, possibly concurrently from multiple
+ * threads. Operations on the same path are always executed sequentially
+ * in the order they appear in @paths. Once @func fails no further items are
+ * processed. On return, @done[i] is set to true for every item which was
+ * successfully relabelled so that the caller can roll them back on failure.
+ *
+ * Returns: 0 on success,
+ *         -1 if @func failed for any item (with error reported).
+ */
+int
+virSecurityRelabelParallel(const char **paths,
+                           size_t npaths,
+                           virSecurityRelabelFunc func,
+                           void *opaque,
+                           bool *done)
+{
+    g_autofree virSecurityRelabelWorker *workers = NULL;
+    size_t nworkers;
+    int failed = 0;
+    bool reported = false;
+    size_t i;
+
+    nworkers = npaths / VIR_SECURITY_RELABEL_PATHS_PER_WORKER;
+    nworkers = MIN(nworkers, VIR_SECURITY_RELABEL_WORKERS_MAX);
+    if (nworkers == 0)
+        nworkers = 1;
+
+    workers = g_new0(virSecurityRelabelWorker, nworkers);
+
+    for (i = 0; i < nworkers; i++) {
+        workers[i].id = i;
+        workers[i].nworkers = nworkers;
+        workers[i].paths = paths;
+        workers[i].npaths = npaths;
+        workers[i].func = func;
+        workers[i].opaque = opaque;
+        workers[i].done = done;
+        workers[i].failed = &failed;
+    }
+
+    /* If a thread can't be created its share of the work is done by the
+     * calling thread afterwards. */
+    for (i = 1; i < nworkers; i++) {
+        if (virThreadCreateFull(&workers[i].thread, true,
+                                virSecurityRelabelWorkerRun,
+                                "sec-relabel", false, &workers[i]) == 0)
+            workers[i].running = true;
+    }
+
+    virSecurityRelabelWorkerRun(&workers[0]);
+
+    for (i = 1; i < nworkers; i++) {
+        if (workers[i].running)
+            virThreadJoin(&workers[i].thread);
+        else
+            virSecurityRelabelWorkerRun(&workers[i]);
+    }
+
+    /* Report the error of the first failed worker. */
+    for (i = 0; i < nworkers; i++) {
+        if (!workers[i].err)
+            continue;
+
+        if (!reported) {
+            virErrorRestore(&workers[i].err);
+            reported = true;
+        } else {
+            g_clear_pointer(&workers[i].err, virFreeError);
+        }
+    }
+
+    if (failed)
+        return -1;
+
+    return 0;
+}
@@ -35,3 +35,13 @@ virSecurityMoveRememberedLabel(const char *name,
 
 bool
 virSecurityXATTRNamespaceDefined(void);
+
+typedef int (*virSecurityRelabelFunc)(size_t idx,
+                                      void *opaque);
+
+int
+virSecurityRelabelParallel(const char **paths,
+                           size_t npaths,
+                           virSecurityRelabelFunc func,
+                           void *opaque,
+                           bool *done);
@@ -34,6 +34,8 @@
 #include "virfile.h"
 #include "virstring.h"
 #include "virutil.h"
+#include "virhash.h"
+#include "virthread.h"
 #include "storage_util.h"
 
 #define VIR_FROM_THIS VIR_FROM_STORAGE
@@ -112,6 +114,7 @@ virStorageBackendLogicalInitializeDevice(const char *path)
 struct virStorageBackendLogicalPoolVolData {
     virStoragePoolObj *pool;
     virStorageVolDef *vol;
+    GPtrArray *rows; /* if non-NULL, lvs output rows are recorded here */
 };
 
 static int
@@ -340,9 +343,267 @@ virStorageBackendLogicalMakeVol(char **const groups,
            VIR_STORAGE_VOL_LOGICAL_LV_ATTR_REGEX \
            VIR_STORAGE_VOL_LOGICAL_SUFFIX_REGEX
 
+
+/*
+ * Forking lvs for every refresh is expensive for volume groups with many
+ * logical volumes. The rows lvs printed are therefore kept per volume group
+ * together with the metadata sequence number of the volume group, which LVM
+ * increments on every metadata change. As long as vgs, which a refresh needs
+ * to run anyway, reports the same volume group and sequence number, the
+ * cached rows are replayed instead of running lvs again. Changes done by
+ * libvirt itself are applied to the cache as they happen.
+ */
+typedef struct _virStorageBackendLogicalVGCache virStorageBackendLogicalVGCache;
+struct _virStorageBackendLogicalVGCache {
+    char *uuid;
+    unsigned long long seqno;
+    GPtrArray *rows; /* GStrv rows as parsed by VIR_STORAGE_VOL_LOGICAL_REGEX */
+};
+
+static virMutex virStorageBackendLogicalCacheLock = VIR_MUTEX_INITIALIZER;
+static GHashTable *virStorageBackendLogicalCache; /* VG name -> cache */
+
+
+static void
+virStorageBackendLogicalVGCacheFree(virStorageBackendLogicalVGCache *cache)
+{
+    if (!cache)
+        return;
+
+    g_free(cache->uuid);
+    g_clear_pointer(&cache->rows, g_ptr_array_unref);
+    g_free(cache);
+}
+
+
+static GPtrArray *
+virStorageBackendLogicalRowsNew(void)
+{
+    return g_ptr_array_new_with_free_func((GDestroyNotify) g_strfreev);
+}
+
+
+static char **
+virStorageBackendLogicalRowCopy(char **const groups)
+{
+    char **row = g_new0(char *, VIR_STORAGE_VOL_LOGICAL_REGEX_COUNT + 1);
+    size_t i;
+
+    for (i = 0; i < VIR_STORAGE_VOL_LOGICAL_REGEX_COUNT; i++)
+        row[i] = g_strdup(groups[i]);
+
+    return row;
+}
+
+
+static void
+virStorageBackendLogicalCacheDrop(const char *vgname)
+{
+    VIR_LOCK_GUARD lock = virLockGuardLock(&virStorageBackendLogicalCacheLock);
+
+    if (virStorageBackendLogicalCache &&
+        g_hash_table_remove(virStorageBackendLogicalCache, vgname))
+        VIR_DEBUG("Dropped LVM metadata cache of '%s'", vgname);
+}
+
+
+static void
+virStorageBackendLogicalCacheSet(const char *vgname,
+                                 const char *uuid,
+                                 unsigned long long seqno,
+                                 GPtrArray *rows)
+{
+    VIR_LOCK_GUARD lock = virLockGuardLock(&virStorageBackendLogicalCacheLock);
+    virStorageBackendLogicalVGCache *cache = g_new0(virStorageBackendLogicalVGCache, 1);
+
+    if (!virStorageBackendLogicalCache)
+        virStorageBackendLogicalCache = virHashNew((GDestroyNotify) virStorageBackendLogicalVGCacheFree);
+
+    cache->uuid = g_strdup(uuid);
+    cache->seqno = seqno;
+    cache->rows = rows;
+
+    g_hash_table_insert(virStorageBackendLogicalCache, g_strdup(vgname), cache);
+}
+
+
+/*
+ * Returns a reference to the cached lvs rows of @vgname if they describe
+ * the volume group @uuid at metadata sequence number @seqno, NULL otherwise.
+ */
+static GPtrArray *
+virStorageBackendLogicalCacheLookup(const char *vgname,
+                                    const char *uuid,
+                                    unsigned long long seqno)
+{
+    VIR_LOCK_GUARD lock = virLockGuardLock(&virStorageBackendLogicalCacheLock);
+    virStorageBackendLogicalVGCache *cache;
+
+    if (!virStorageBackendLogicalCache ||
+        !(cache = g_hash_table_lookup(virStorageBackendLogicalCache, vgname)))
+        return NULL;
+
+    if (STRNEQ(cache->uuid, uuid) || cache->seqno != seqno) {
+        VIR_DEBUG("LVM metadata of '%s' changed, seqno %llu -> %llu",
+                  vgname, cache->seqno, seqno);
+        return NULL;
+    }
+
+    return g_ptr_array_ref(cache->rows);
+}
+
+
+/*
+ * Activating or deactivating logical volumes does not change the sequence
+ * number. Make sure the active volumes in @rows match the device nodes in
+ * the pool's target directory before relying on them.
+ */
+static bool
+virStorageBackendLogicalCacheMatchDevices(virStoragePoolDef *def,
+                                          GPtrArray *rows)
+{
+    g_autoptr(GHashTable) active = g_hash_table_new(g_str_hash, g_str_equal);
+    g_autoptr(DIR) dir = NULL;
+    struct dirent *ent;
+    size_t i;
+    int rc;
+
+    for (i = 0; i < rows->len; i++) {
+        char **row = g_ptr_array_index(rows, i);
+        const char *attrs = row[9];
+
+        /* Same filter as virStorageBackendLogicalMakeVol */
+        if (attrs[4] == 'a' && attrs[0] != 't')
+            g_hash_table_add(active, row[0]);
+    }
+
+    if (virDirOpenQuiet(&dir, def->target.path) < 0)
+        return errno == ENOENT && g_hash_table_size(active) == 0;
+
+    while ((rc = virDirRead(dir, &ent, NULL)) > 0) {
+        if (!g_hash_table_remove(active, ent->d_name))
+            return false;
+    }
+
+    return rc == 0 && g_hash_table_size(active) == 0;
+}
+
+
+static int
+virStorageBackendLogicalGetSeqno(const char *vgname,
+                                 char **uuid,
+                                 unsigned long long *seqno)
+{
+    g_autoptr(virCommand) cmd = NULL;
+    g_autofree char *output = NULL;
+    g_auto(GStrv) fields = NULL;
+
+    cmd = virCommandNewArgList(VGS,
+                               "--separator", ":",
+                               "--noheadings",
+                               "--unbuffered",
+                               "--options", "vg_uuid,vg_seq_no",
+                               vgname,
+                               NULL);
+    virCommandSetOutputBuffer(cmd, &output);
+
+    if (virCommandRun(cmd, NULL) < 0)
+        return -1;
+
+    fields = g_strsplit(g_strstrip(output), ":", 0);
+    if (g_strv_length(fields) < 2 ||
+        virStrToLong_ull(fields[1], NULL, 10, seqno) < 0) {
+        virReportError(VIR_ERR_INTERNAL_ERROR,
+                       _("malformed vgs output for volume group '%s'"),
+                       vgname);
+        return -1;
+    }
+
+    *uuid = g_strdup(fields[0]);
+    return 0;
+}
+
+
+/*
+ * Applies a change of logical volume @volname done by libvirt to the cache
+ * of @vgname. @rows are the lvs rows of the volume after the change, or
+ * NULL if it was removed. The cache is kept only if the change was the only
+ * metadata update of the volume group since it was filled, otherwise it is
+ * dropped and the next refresh rescans the volume group.
+ */
+static void
+virStorageBackendLogicalCacheUpdateVol(const char *vgname,
+                                       const char *volname,
+                                       GPtrArray *rows)
+{
+    virStorageBackendLogicalVGCache *cache;
+    g_autofree char *uuid = NULL;
+    unsigned long long seqno = 0;
+    GPtrArray *newrows;
+    size_t i;
+    int rc;
+
+    /* Don't bother running vgs if there is nothing to update */
+    VIR_WITH_MUTEX_LOCK_GUARD(&virStorageBackendLogicalCacheLock) {
+        if (!virStorageBackendLogicalCache ||
+            !g_hash_table_contains(virStorageBackendLogicalCache, vgname))
+            return;
+    }
+
+    if ((rc = virStorageBackendLogicalGetSeqno(vgname, &uuid, &seqno)) < 0)
+        virResetLastError();
+
+    VIR_WITH_MUTEX_LOCK_GUARD(&virStorageBackendLogicalCacheLock) {
+        /* the entry may have been dropped meanwhile */
+        if (!(cache = g_hash_table_lookup(virStorageBackendLogicalCache, vgname)))
+            return;
+
+        if (rc < 0 || STRNEQ(cache->uuid, uuid) || seqno != cache->seqno + 1) {
+            VIR_DEBUG("Dropped LVM metadata cache of '%s' after changing '%s'",
+                      vgname, volname);
+            g_hash_table_remove(virStorageBackendLogicalCache, vgname);
+            return;
+        }
+
+        /* The rows may be replayed by a refresh right now, don't modify
+         * them in place */
+        newrows = virStorageBackendLogicalRowsNew();
+        for (i = 0; i < cache->rows->len; i++) {
+            char **row = g_ptr_array_index(cache->rows, i);
+
+            if (STRNEQ(row[0], volname))
+                g_ptr_array_add(newrows, g_strdupv(row));
+        }
+        for (i = 0; rows && i < rows->len; i++)
+            g_ptr_array_add(newrows, g_strdupv(g_ptr_array_index(rows, i)));
+
+        g_ptr_array_unref(cache->rows);
+        cache->rows = newrows;
+        cache->seqno = seqno;
+    }
+}
+
+
+static int
+virStorageBackendLogicalRecordVol(char **const groups,
+                                  void *opaque)
+{
+    struct virStorageBackendLogicalPoolVolData *data = opaque;
+
+    g_ptr_array_add(data->rows, virStorageBackendLogicalRowCopy(groups));
+
+    return virStorageBackendLogicalMakeVol(groups, opaque);
+}
+
+
+/*
+ * Fills in @vol, or all volumes of @pool if @vol is NULL, from lvs output.
+ * If @rows is non-NULL, the parsed rows are appended to it.
+ */
 static int
 virStorageBackendLogicalFindLVs(virStoragePoolObj *pool,
-                                virStorageVolDef *vol)
+                                virStorageVolDef *vol,
+                                GPtrArray *rows)
 {
     /*
      * # lvs --separator # --noheadings --units b --unbuffered --nosuffix --options \
@@ -379,8 +640,14 @@ virStorageBackendLogicalFindLVs(virStoragePoolObj *pool,
     struct virStorageBackendLogicalPoolVolData cbdata = {
         .pool = pool,
         .vol = vol,
+        .rows = rows,
     };
     g_autoptr(virCommand) cmd = NULL;
+    g_autofree char *lvname = NULL;
+
+    /* Don't list the whole volume group when looking for a single volume */
+    if (vol)
+        lvname = g_strdup_printf("%s/%s", def->source.name, vol->name);
 
     cmd = virCommandNewArgList(LVS,
                                "--separator", "#",
@@ -390,19 +657,26 @@ virStorageBackendLogicalFindLVs(virStoragePoolObj *pool,
                                "--nosuffix",
                                "--options",
                                "lv_name,origin,uuid,devices,segtype,stripes,seg_size,vg_extent_size,size,lv_attr",
-                               def->source.name,
+                               lvname ? lvname : def->source.name,
                                NULL);
     return virCommandRunRegex(cmd, 1, regexes, vars,
-                              virStorageBackendLogicalMakeVol,
+                              rows ? virStorageBackendLogicalRecordVol :
+                                     virStorageBackendLogicalMakeVol,
                               &cbdata, "lvs", NULL);
 }
 
+struct virStorageBackendLogicalRefreshData {
+    virStoragePoolObj *pool;
+    char *uuid;
+    unsigned long long seqno;
+};
+
 static int
 virStorageBackendLogicalRefreshPoolFunc(char **const groups,
-                                        void *data)
+                                        void *opaque)
 {
-    virStoragePoolObj *pool = data;
-    virStoragePoolDef *def = virStoragePoolObjGetDef(pool);
+    struct virStorageBackendLogicalRefreshData *data = opaque;
+    virStoragePoolDef *def = virStoragePoolObjGetDef(data->pool);
 
     if (virStrToLong_ull(groups[0], NULL, 10, &def->capacity) < 0)
         return -1;
@@ -410,6 +684,11 @@ virStorageBackendLogicalRefreshPoolFunc(char **const groups,
         return -1;
     def->allocation = def->capacity - def->available;
 
+    g_free(data->uuid);
+    data->uuid = g_strdup(groups[2]);
+    if (virStrToLong_ull(groups[3], NULL, 10, &data->seqno) < 0)
+        return -1;
+
     return 0;
 }
 
@@ -644,6 +923,10 @@ virStorageBackendLogicalStartPool(virStoragePoolObj *pool)
     /* Let's make sure that the pool's name matches the pvs output and
      * that the pool's source devices match the pvs output.
      */
+    virStoragePoolDef *def = virStoragePoolObjGetDef(pool);
+
+    virStorageBackendLogicalCacheDrop(def->source.name);
+
     if (!virStorageBackendLogicalMatchPoolSource(pool) ||
         virStorageBackendLogicalSetActive(pool, true) < 0)
         return -1;
@@ -708,50 +991,93 @@ static int
 virStorageBackendLogicalRefreshPool(virStoragePoolObj *pool)
 {
     /*
-     *  # vgs --separator : --noheadings --units b --unbuffered --nosuffix --options "vg_size,vg_free" VGNAME
-     *    10603200512:4328521728
+     *  # vgs --separator : --noheadings --units b --unbuffered --nosuffix --options "vg_size,vg_free,vg_uuid,vg_seq_no" VGNAME
+     *    10603200512:4328521728:AXgFhp-oRaY-vqjr-bNnQ-B5y6-v0oH-Dv6mOC:42
      *
-     * Pull out size & free
+     * Pull out size, free, uuid & metadata sequence number
      *
      * NB vgs from some distros (e.g. SLES10 SP2) outputs trailing ":" on each line
      */
     const char *regexes[] = {
-        "^\\s*(\\S+):([0-9]+):?\\s*$"
+        "^\\s*(\\S+):([0-9]+):(\\S+):([0-9]+):?\\s*$"
     };
     int vars[] = {
-        2
+        4
     };
     virStoragePoolDef *def = virStoragePoolObjGetDef(pool);
+    struct virStorageBackendLogicalRefreshData data = {
+        .pool = pool,
+    };
+    struct virStorageBackendLogicalPoolVolData cbdata = {
+        .pool = pool,
+    };
     g_autoptr(virCommand) cmd = NULL;
+    g_autoptr(GPtrArray) rows = NULL;
+    size_t i;
+    int ret = -1;
 
     virWaitForDevices();
 
-    /* Get list of all logical volumes */
-    if (virStorageBackendLogicalFindLVs(pool, NULL) < 0)
-        return -1;
-
     cmd = virCommandNewArgList(VGS,
                                "--separator", ":",
                                "--noheadings",
                                "--units", "b",
                                "--unbuffered",
                                "--nosuffix",
-                               "--options", "vg_size,vg_free",
+                               "--options", "vg_size,vg_free,vg_uuid,vg_seq_no",
                                def->source.name,
                                NULL);
 
-    /* Now get basic volgrp metadata */
+    /* Get basic volgrp metadata first, it tells whether cached lvs
+     * output is still valid */
     if (virCommandRunRegex(cmd,
                            1,
                            regexes,
                            vars,
                            virStorageBackendLogicalRefreshPoolFunc,
-                           pool,
+                           &data,
                            "vgs",
                            NULL) < 0)
-        return -1;
+        goto cleanup;
 
-    return 0;
+    if (data.uuid &&
+        (rows = virStorageBackendLogicalCacheLookup(def->source.name,
+                                                    data.uuid, data.seqno))) {
+        if (virStorageBackendLogicalCacheMatchDevices(def, rows)) {
+            VIR_DEBUG("Using cached LVM metadata of '%s', seqno %llu",
+                      def->source.name, data.seqno);
+
+            for (i = 0; i < rows->len; i++) {
+                if (virStorageBackendLogicalMakeVol(g_ptr_array_index(rows, i),
+                                                    &cbdata) < 0)
+                    goto cleanup;
+            }
+
+            ret = 0;
+            goto cleanup;
+        }
+
+        VIR_DEBUG("Device nodes of '%s' don't match cached LVM metadata",
+                  def->source.name);
+        g_clear_pointer(&rows, g_ptr_array_unref);
+    }
+
+    /* Get list of all logical volumes */
+    rows = virStorageBackendLogicalRowsNew();
+    if (virStorageBackendLogicalFindLVs(pool, NULL, rows) < 0)
+        goto cleanup;
+
+    if (data.uuid)
+        virStorageBackendLogicalCacheSet(def->source.name, data.uuid,
+                                         data.seqno, g_steal_pointer(&rows));
+
+    ret = 0;
+
+ cleanup:
+    if (ret < 0)
+        virStorageBackendLogicalCacheDrop(def->source.name);
+    g_free(data.uuid);
+    return ret;
 }
 
 /*
@@ -762,6 +1088,10 @@ virStorageBackendLogicalRefreshPool(virStoragePoolObj *pool)
 static int
 virStorageBackendLogicalStopPool(virStoragePoolObj *pool)
 {
+    virStoragePoolDef *def = virStoragePoolObjGetDef(pool);
+
+    virStorageBackendLogicalCacheDrop(def->source.name);
+
     if (virStorageBackendLogicalSetActive(pool, false) < 0)
         return -1;
 
@@ -778,6 +1108,8 @@ virStorageBackendLogicalDeletePool(virStoragePoolObj *pool,
 
     virCheckFlags(0, -1);
 
+    virStorageBackendLogicalCacheDrop(def->source.name);
+
     /* first remove the volume group */
     cmd = virCommandNewArgList(VGREMOVE,
                                "-f", def->source.name,
@@ -794,10 +1126,11 @@ virStorageBackendLogicalDeletePool(virStoragePoolObj *pool,
 
 
 static int
-virStorageBackendLogicalDeleteVol(virStoragePoolObj *pool G_GNUC_UNUSED,
+virStorageBackendLogicalDeleteVol(virStoragePoolObj *pool,
                                   virStorageVolDef *vol,
                                   unsigned int flags)
 {
+    virStoragePoolDef *def = virStoragePoolObjGetDef(pool);
     g_autoptr(virCommand) lvchange_cmd = NULL;
     g_autoptr(virCommand) lvremove_cmd = NULL;
 
@@ -817,6 +1150,8 @@ virStorageBackendLogicalDeleteVol(virStoragePoolObj *pool G_GNUC_UNUSED,
         }
     }
 
+    virStorageBackendLogicalCacheUpdateVol(def->source.name, vol->name, NULL);
+
     return 0;
 }
 
@@ -873,6 +1208,7 @@ virStorageBackendLogicalCreateVol(virStoragePoolObj *pool,
     virErrorPtr err;
     struct stat sb;
     VIR_AUTOCLOSE fd = -1;
+    g_autoptr(GPtrArray) rows = NULL;
 
     vol->type = VIR_STORAGE_VOL_BLOCK;
 
@@ -916,13 +1252,16 @@ virStorageBackendLogicalCreateVol(virStoragePoolObj *pool,
     }
 
     /* Fill in data about this new vol */
-    if (virStorageBackendLogicalFindLVs(pool, vol) < 0) {
+    rows = virStorageBackendLogicalRowsNew();
+    if (virStorageBackendLogicalFindLVs(pool, vol, rows) < 0) {
         virReportSystemError(errno,
                              _("cannot find newly created volume '%s'"),
                              vol->target.path);
         goto error;
     }
 
+    virStorageBackendLogicalCacheUpdateVol(def->source.name, vol->name, rows);
+
     return 0;
 
  error:
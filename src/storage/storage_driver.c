@@ -56,6 +56,10 @@ VIR_LOG_INIT("storage.storage_driver");
 static virStorageDriverState *driver;
 
 static int storageStateCleanup(void);
+static void storageVolBuildJobWorker(void *jobdata, void *opaque);
+
+/* Maximum number of volumes built in the background at once */
+#define STORAGE_VOL_BUILD_WORKERS 4
 
 typedef struct _virStorageVolStreamInfo virStorageVolStreamInfo;
 struct _virStorageVolStreamInfo {
@@ -86,13 +90,18 @@ storagePoolRefreshImpl(virStorageBackend *backend,
                        virStoragePoolObj *obj,
                        const char *stateFile)
 {
-    virStoragePoolObjClearVols(obj);
+    int ret = 0;
+
+    /* Backends may reuse definitions of volumes which did not change since
+     * the last refresh, the rest is freed once the refresh is done. */
+    virStoragePoolObjStashVols(obj);
     if (backend->refreshPool(obj) < 0) {
         storagePoolRefreshFailCleanup(backend, obj, stateFile);
-        return -1;
+        ret = -1;
     }
 
-    return 0;
+    virStoragePoolObjDropStashedVols(obj);
+    return ret;
 }
 
 
@@ -318,6 +327,15 @@ storageStateInitialize(bool privileged,
     if (!(driver->caps = virStorageBackendGetCapabilities()))
         goto error;
 
+    if (!(driver->volBuildPool = virThreadPoolNewFull(0,
+                                                      STORAGE_VOL_BUILD_WORKERS,
+                                                      0,
+                                                      storageVolBuildJobWorker,
+                                                      "vol-build",
+                                                      NULL,
+                                                      NULL)))
+        goto error;
+
     return VIR_DRV_STATE_INIT_COMPLETE;
 
  error:
@@ -360,6 +378,8 @@ storageStateCleanup(void)
     if (!driver)
         return -1;
 
+    /* Waits for volumes being built in the background */
+    virThreadPoolFree(driver->volBuildPool);
     virObjectUnref(driver->caps);
     virObjectUnref(driver->storageEventState);
 
@@ -1867,6 +1887,253 @@ storageVolDelete(virStorageVolPtr vol,
 }
 
 
+typedef struct _virStorageVolBuildJob virStorageVolBuildJob;
+struct _virStorageVolBuildJob {
+    virStoragePoolObj *obj;
+    virStoragePoolObj *objsrc; /* pool of @voldefsrc if it differs from @obj */
+    virStorageBackend *backend;
+    virStorageVolDef *voldef; /* owned by the pool */
+    virStorageVolDef *voldefsrc; /* volume to clone, NULL when not cloning */
+    virStorageVolDef *buildvoldef;
+    unsigned int flags;
+};
+
+
+static void
+storageVolBuildJobFree(virStorageVolBuildJob *job)
+{
+    if (!job)
+        return;
+
+    virObjectUnref(job->obj);
+    virObjectUnref(job->objsrc);
+    g_free(job->buildvoldef);
+    g_free(job);
+}
+
+
+static virStorageVolBuildJob *
+storageVolBuildJobNew(virStoragePoolObj *obj,
+                      virStoragePoolObj *objsrc,
+                      virStorageBackend *backend,
+                      virStorageVolDef *voldef,
+                      virStorageVolDef *voldefsrc,
+                      unsigned int flags)
+{
+    virStorageVolBuildJob *job = g_new0(virStorageVolBuildJob, 1);
+
+    job->obj = virObjectRef(obj);
+    if (objsrc)
+        job->objsrc = virObjectRef(objsrc);
+    job->backend = backend;
+    job->voldef = voldef;
+    job->voldefsrc = voldefsrc;
+    job->flags = flags & ~VIR_STORAGE_VOL_CREATE_BACKGROUND;
+
+    /* Make a shallow copy of the 'defined' volume definition, since the
+     * original allocation value will change as the user polls 'info',
+     * but we only need the initial requested values
+     */
+    job->buildvoldef = g_new0(virStorageVolDef, 1);
+    memcpy(job->buildvoldef, voldef, sizeof(*voldef));
+
+    return job;
+}
+
+
+/*
+ * Marks the volume as being built. Must be called with the pool
+ * objects locked.
+ */
+static void
+storageVolBuildJobBegin(virStorageVolBuildJob *job)
+{
+    virStoragePoolObjIncrAsyncjobs(job->obj);
+    job->voldef->building = true;
+
+    if (job->voldefsrc)
+        job->voldefsrc->in_use++;
+
+    if (job->objsrc)
+        virStoragePoolObjIncrAsyncjobs(job->objsrc);
+}
+
+
+/*
+ * Writes the volume data. Must be called with the pool objects unlocked.
+ */
+static int
+storageVolBuildJobRun(virStorageVolBuildJob *job)
+{
+    if (job->voldefsrc)
+        return job->backend->buildVolFrom(job->obj, job->buildvoldef,
+                                          job->voldefsrc, job->flags);
+
+    return job->backend->buildVol(job->obj, job->buildvoldef, job->flags);
+}
+
+
+/*
+ * Reverts storageVolBuildJobBegin. Must be called with the pool
+ * objects locked.
+ */
+static void
+storageVolBuildJobRelease(virStorageVolBuildJob *job)
+{
+    if (job->voldefsrc)
+        job->voldefsrc->in_use--;
+    job->voldef->building = false;
+    virStoragePoolObjDecrAsyncjobs(job->obj);
+
+    if (job->objsrc)
+        virStoragePoolObjDecrAsyncjobs(job->objsrc);
+}
+
+
+/*
+ * Finishes building the volume according to @buildret: the volume is
+ * refreshed and accounted in the pool, or removed from the pool if any
+ * of that failed. Must be called with the pool objects locked.
+ *
+ * Returns 0 on success, -1 if the volume was removed.
+ */
+static int
+storageVolBuildJobEnd(virStorageVolBuildJob *job,
+                      int buildret)
+{
+    virStoragePoolDef *def = virStoragePoolObjGetDef(job->obj);
+
+    storageVolBuildJobRelease(job);
+
+    if (buildret < 0 && !job->voldefsrc) {
+        /* buildVol handles deleting volume on failure */
+        virStoragePoolObjRemoveVol(job->obj, job->voldef);
+        return -1;
+    }
+
+    if (buildret < 0 ||
+        (job->backend->refreshVol &&
+         job->backend->refreshVol(job->obj, job->voldef) < 0)) {
+        storageVolDeleteInternal(job->backend, job->obj, job->voldef,
+                                 0, false);
+        return -1;
+    }
+
+    /* Update pool metadata ignoring the disk backend since
+     * it updates the pool values.
+     */
+    if (def->type != VIR_STORAGE_POOL_DISK) {
+        def->allocation += job->voldef->target.allocation;
+        def->available -= job->voldef->target.allocation;
+    }
+
+    return 0;
+}
+
+
+/*
+ * Builds the volume synchronously. Must be called with the pool
+ * objects locked, which are temporarily dropped while writing
+ * the volume data.
+ */
+static int
+storageVolBuildJobExec(virStorageVolBuildJob *job)
+{
+    int buildret;
+
+    storageVolBuildJobBegin(job);
+    virObjectUnlock(job->obj);
+    if (job->objsrc)
+        virObjectUnlock(job->objsrc);
+
+    buildret = storageVolBuildJobRun(job);
+
+    virObjectLock(job->obj);
+    if (job->objsrc)
+        virObjectLock(job->objsrc);
+
+    return storageVolBuildJobEnd(job, buildret);
+}
+
+
+/*
+ * Drops a job whose build never started and deletes the volume
+ * created for it. Must be called with the pool objects locked.
+ */
+static void
+storageVolBuildJobCancel(virStorageVolBuildJob *job)
+{
+    virErrorPtr orig_err;
+
+    storageVolBuildJobRelease(job);
+
+    virErrorPreserveLast(&orig_err);
+    if (storageVolDeleteInternal(job->backend, job->obj, job->voldef,
+                                 0, false) < 0)
+        virStoragePoolObjRemoveVol(job->obj, job->voldef);
+    virErrorRestore(&orig_err);
+}
+
+
+/*
+ * Hands the job over to the background build workers. Must be called
+ * with the pool objects locked. On success @job is consumed, on failure
+ * the volume is removed.
+ */
+static int
+storageVolBuildJobSubmit(virStorageVolBuildJob *job)
+{
+    storageVolBuildJobBegin(job);
+
+    if (virThreadPoolSendJob(driver->volBuildPool, 0, job) < 0) {
+        storageVolBuildJobCancel(job);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+static void
+storageVolBuildJobWorker(void *jobdata,
+                         void *opaque G_GNUC_UNUSED)
+{
+    virStorageVolBuildJob *job = jobdata;
+    virStoragePoolDef *def;
+    virObjectEvent *event = NULL;
+    g_autofree char *volname = g_strdup(job->voldef->name);
+    int buildret;
+
+    VIR_DEBUG("Building volume '%s' in the background", volname);
+
+    buildret = storageVolBuildJobRun(job);
+
+    virObjectLock(job->obj);
+    if (job->objsrc)
+        virObjectLock(job->objsrc);
+
+    def = virStoragePoolObjGetDef(job->obj);
+
+    if (storageVolBuildJobEnd(job, buildret) < 0) {
+        VIR_WARN("Failed to build volume '%s' in storage pool '%s': %s",
+                 volname, def->name, virGetLastErrorMessage());
+        virResetLastError();
+    } else {
+        VIR_INFO("Created volume '%s' in storage pool '%s'",
+                 volname, def->name);
+    }
+
+    event = virStoragePoolEventRefreshNew(def->name, def->uuid);
+
+    if (job->objsrc)
+        virObjectUnlock(job->objsrc);
+    virObjectUnlock(job->obj);
+
+    virObjectEventStateQueue(driver->storageEventState, event);
+    storageVolBuildJobFree(job);
+}
+
+
 static virStorageVolPtr
 storageVolCreateXML(virStoragePoolPtr pool,
                     const char *xmldesc,
@@ -1876,11 +2143,13 @@ storageVolCreateXML(virStoragePoolPtr pool,
     virStoragePoolDef *def;
     virStorageBackend *backend;
     virStorageVolPtr vol = NULL, newvol = NULL;
+    virStorageVolBuildJob *job = NULL;
     g_autoptr(virStorageVolDef) voldef = NULL;
     unsigned int parseFlags = VIR_VOL_XML_PARSE_OPT_CAPACITY;
 
     virCheckFlags(VIR_STORAGE_VOL_CREATE_PREALLOC_METADATA |
-                  VIR_STORAGE_VOL_CREATE_VALIDATE, NULL);
+                  VIR_STORAGE_VOL_CREATE_VALIDATE |
+                  VIR_STORAGE_VOL_CREATE_BACKGROUND, NULL);
 
     if (flags & VIR_STORAGE_VOL_CREATE_VALIDATE)
         parseFlags |= VIR_VOL_XML_PARSE_VALIDATE;
@@ -1940,38 +2209,21 @@ storageVolCreateXML(virStoragePoolPtr pool,
         goto cleanup;
 
     if (backend->buildVol) {
-        int buildret;
-        virStorageVolDef *buildvoldef = NULL;
-
-        buildvoldef = g_new0(virStorageVolDef, 1);
-
-        /* Make a shallow copy of the 'defined' volume definition, since the
-         * original allocation value will change as the user polls 'info',
-         * but we only need the initial requested values
-         */
-        memcpy(buildvoldef, voldef, sizeof(*voldef));
-
-        /* Drop the pool lock during volume allocation */
-        virStoragePoolObjIncrAsyncjobs(obj);
-        voldef->building = true;
-        virObjectUnlock(obj);
-
-        buildret = backend->buildVol(obj, buildvoldef, flags);
-
-        VIR_FREE(buildvoldef);
-
-        virObjectLock(obj);
-
-        voldef->building = false;
-        virStoragePoolObjDecrAsyncjobs(obj);
+        job = storageVolBuildJobNew(obj, NULL, backend, voldef, NULL, flags);
+        voldef = NULL;
 
-        if (buildret < 0) {
-            /* buildVol handles deleting volume on failure */
-            virStoragePoolObjRemoveVol(obj, voldef);
-            voldef = NULL;
+        if (flags & VIR_STORAGE_VOL_CREATE_BACKGROUND) {
+            if (storageVolBuildJobSubmit(job) < 0)
+                goto cleanup;
+            job = NULL;
+        } else if (storageVolBuildJobExec(job) < 0) {
             goto cleanup;
         }
 
+        VIR_INFO("Creating volume '%s' in storage pool '%s'",
+                 newvol->name, def->name);
+        vol = g_steal_pointer(&newvol);
+        goto cleanup;
     }
 
     if (backend->refreshVol &&
@@ -1996,6 +2248,7 @@ storageVolCreateXML(virStoragePoolPtr pool,
     voldef = NULL;
 
  cleanup:
+    storageVolBuildJobFree(job);
     virObjectUnref(newvol);
     virStoragePoolObjEndAPI(&obj);
     return vol;
@@ -2012,16 +2265,16 @@ storageVolCreateXMLFrom(virStoragePoolPtr pool,
     virStoragePoolObj *objsrc = NULL;
     virStorageBackend *backend;
     virStorageVolDef *voldefsrc = NULL;
-    virStorageVolDef *shadowvol = NULL;
+    virStorageVolBuildJob *job = NULL;
     virStorageVolPtr newvol = NULL;
     virStorageVolPtr vol = NULL;
-    int buildret;
     g_autoptr(virStorageVolDef) voldef = NULL;
     unsigned int parseFlags = VIR_VOL_XML_PARSE_NO_CAPACITY;
 
     virCheckFlags(VIR_STORAGE_VOL_CREATE_PREALLOC_METADATA |
                   VIR_STORAGE_VOL_CREATE_REFLINK |
-                  VIR_STORAGE_VOL_CREATE_VALIDATE,
+                  VIR_STORAGE_VOL_CREATE_VALIDATE |
+                  VIR_STORAGE_VOL_CREATE_BACKGROUND,
                   NULL);
 
     if (flags & VIR_STORAGE_VOL_CREATE_VALIDATE)
@@ -2127,14 +2380,6 @@ storageVolCreateXMLFrom(virStoragePoolPtr pool,
     if (backend->createVol(obj, voldef) < 0)
         goto cleanup;
 
-    /* Make a shallow copy of the 'defined' volume definition, since the
-     * original allocation value will change as the user polls 'info',
-     * but we only need the initial requested values
-     */
-    shadowvol = g_new0(virStorageVolDef, 1);
-
-    memcpy(shadowvol, voldef, sizeof(*voldef));
-
     if (!(newvol = virGetStorageVol(pool->conn, def->name, voldef->name,
                                     voldef->key, NULL, NULL)))
         goto cleanup;
@@ -2143,56 +2388,24 @@ storageVolCreateXMLFrom(virStoragePoolPtr pool,
     if (virStoragePoolObjAddVol(obj, voldef) < 0)
         goto cleanup;
 
-    /* Drop the pool lock during volume allocation */
-    virStoragePoolObjIncrAsyncjobs(obj);
-    voldef->building = true;
-    voldefsrc->in_use++;
-    virObjectUnlock(obj);
-
-    if (objsrc) {
-        virStoragePoolObjIncrAsyncjobs(objsrc);
-        virObjectUnlock(objsrc);
-    }
-
-    buildret = backend->buildVolFrom(obj, shadowvol, voldefsrc, flags);
-
-    virObjectLock(obj);
-    if (objsrc)
-        virObjectLock(objsrc);
-
-    voldefsrc->in_use--;
-    voldef->building = false;
-    virStoragePoolObjDecrAsyncjobs(obj);
-
-    if (objsrc) {
-        virStoragePoolObjDecrAsyncjobs(objsrc);
-        virStoragePoolObjEndAPI(&objsrc);
-    }
+    job = storageVolBuildJobNew(obj, objsrc, backend, voldef, voldefsrc, flags);
+    voldef = NULL;
 
-    if (buildret < 0 ||
-        (backend->refreshVol &&
-         backend->refreshVol(obj, voldef) < 0)) {
-        storageVolDeleteInternal(backend, obj, voldef, 0, false);
-        voldef = NULL;
+    if (flags & VIR_STORAGE_VOL_CREATE_BACKGROUND) {
+        if (storageVolBuildJobSubmit(job) < 0)
+            goto cleanup;
+        job = NULL;
+    } else if (storageVolBuildJobExec(job) < 0) {
         goto cleanup;
     }
 
-    /* Updating pool metadata ignoring the disk backend since
-     * it updates the pool values
-     */
-    if (def->type != VIR_STORAGE_POOL_DISK) {
-        def->allocation += voldef->target.allocation;
-        def->available -= voldef->target.allocation;
-    }
-
     VIR_INFO("Creating volume '%s' in storage pool '%s'",
              newvol->name, def->name);
     vol = g_steal_pointer(&newvol);
-    voldef = NULL;
 
  cleanup:
+    storageVolBuildJobFree(job);
     virObjectUnref(newvol);
-    VIR_FREE(shadowvol);
     virStoragePoolObjEndAPI(&obj);
     virStoragePoolObjEndAPI(&objsrc);
     return vol;
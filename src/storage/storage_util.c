@@ -63,6 +63,7 @@
 #include "virfdstream.h"
 #include "virutil.h"
 #include "virsecureerase.h"
+#include "virhash.h"
 
 #define VIR_FROM_THIS VIR_FROM_STORAGE
 
@@ -113,6 +114,160 @@ reflinkCloneFile(int dest_fd G_GNUC_UNUSED,
 #endif
 
 
+#if WITH_COPY_FILE_RANGE
+/* Amount of data handed to a single copy_file_range() call */
+# define COPY_OFFLOAD_CHUNK_SIZE (1024 * 1024 * 1024)
+
+static bool
+storageBackendCopyOffloadUnsupported(int err)
+{
+    return err == ENOSYS || err == EXDEV || err == EINVAL ||
+           err == EOPNOTSUPP || err == ENOTSUP;
+}
+
+
+/*
+ * Copy up to @total bytes from the current position of @inputfd to
+ * the current position of @fd using copy_file_range(). This lets the
+ * kernel share extents (btrfs, XFS) or perform a server side copy
+ * (NFS 4.2) instead of pumping the data through the daemon. If
+ * @want_sparse is true, holes in the input are found using
+ * SEEK_DATA/SEEK_HOLE and skipped over in the output.
+ *
+ * On return the file positions and @total are updated to reflect
+ * the data copied, so that the caller can continue with a regular
+ * read/write loop if the kernel or filesystem can't offload the
+ * (rest of the) copy.
+ *
+ * Returns 0 on success (even if nothing was copied), -1 on error.
+ */
+static int
+storageBackendCopyOffload(virStorageVolDef *vol,
+                          virStorageVolDef *inputvol,
+                          int inputfd,
+                          int fd,
+                          unsigned long long *total,
+                          bool want_sparse)
+{
+    struct stat st;
+    off_t instart;
+    off_t inoff;
+    off_t outoff;
+    off_t end;
+    int ret = -1;
+
+    /* copy_file_range() works on regular files only */
+    if (fstat(inputfd, &st) < 0 || !S_ISREG(st.st_mode))
+        return 0;
+    end = st.st_size;
+
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode))
+        return 0;
+
+    if ((instart = lseek(inputfd, 0, SEEK_CUR)) < 0 ||
+        (outoff = lseek(fd, 0, SEEK_CUR)) < 0)
+        return 0;
+
+    inoff = instart;
+    if (end < instart)
+        end = instart;
+    if (*total < (unsigned long long)(end - instart))
+        end = instart + *total;
+
+    while (inoff < end) {
+        off_t hole = end;
+
+        if (want_sparse) {
+            off_t data;
+
+            if ((data = lseek(inputfd, inoff, SEEK_DATA)) < 0) {
+                if (errno != ENXIO) {
+                    /* SEEK_DATA not supported, copy everything */
+                    want_sparse = false;
+                    continue;
+                }
+                /* only a hole remains */
+                data = end;
+            } else if ((hole = lseek(inputfd, data, SEEK_HOLE)) < 0) {
+                hole = end;
+            }
+
+            data = MIN(data, end);
+            hole = MIN(hole, end);
+
+            outoff += data - inoff;
+            inoff = data;
+        }
+
+        while (inoff < hole) {
+            ssize_t copied = copy_file_range(inputfd, &inoff, fd, &outoff,
+                                             MIN(hole - inoff,
+                                                 COPY_OFFLOAD_CHUNK_SIZE),
+                                             0);
+
+            if (copied < 0) {
+                if (errno == EINTR)
+                    continue;
+
+                if (storageBackendCopyOffloadUnsupported(errno)) {
+                    VIR_DEBUG("copy offload from '%s' to '%s' not possible, "
+                              "falling back at offset %lld",
+                              inputvol->target.path, vol->target.path,
+                              (long long)inoff);
+                    ret = 0;
+                } else {
+                    virReportSystemError(errno,
+                                         _("failed to copy from '%s' to '%s'"),
+                                         inputvol->target.path,
+                                         vol->target.path);
+                }
+                goto cleanup;
+            }
+
+            /* premature EOF, the input has shrunk meanwhile */
+            if (copied == 0) {
+                end = inoff;
+                break;
+            }
+        }
+    }
+
+    VIR_DEBUG("offloaded copy of %lld bytes from '%s' to '%s'",
+              (long long)(inoff - instart),
+              inputvol->target.path, vol->target.path);
+    ret = 0;
+
+ cleanup:
+    *total -= inoff - instart;
+
+    if (lseek(inputfd, inoff, SEEK_SET) < 0) {
+        virReportSystemError(errno, _("cannot seek in file '%s'"),
+                             inputvol->target.path);
+        return -1;
+    }
+
+    if (lseek(fd, outoff, SEEK_SET) < 0) {
+        virReportSystemError(errno, _("cannot seek in file '%s'"),
+                             vol->target.path);
+        return -1;
+    }
+
+    return ret;
+}
+#else /* !WITH_COPY_FILE_RANGE */
+static int
+storageBackendCopyOffload(virStorageVolDef *vol G_GNUC_UNUSED,
+                          virStorageVolDef *inputvol G_GNUC_UNUSED,
+                          int inputfd G_GNUC_UNUSED,
+                          int fd G_GNUC_UNUSED,
+                          unsigned long long *total G_GNUC_UNUSED,
+                          bool want_sparse G_GNUC_UNUSED)
+{
+    return 0;
+}
+#endif /* !WITH_COPY_FILE_RANGE */
+
+
 static int ATTRIBUTE_NONNULL(2)
 virStorageBackendCopyToFD(virStorageVolDef *vol,
                           virStorageVolDef *inputvol,
@@ -162,6 +317,12 @@ virStorageBackendCopyToFD(virStorageVolDef *vol,
         }
     }
 
+    /* Let the kernel copy as much as it can, anything that is left
+     * over is handled by the loop below. */
+    if (storageBackendCopyOffload(vol, inputvol, inputfd, fd,
+                                  total, want_sparse) < 0)
+        return -1;
+
     while (amtread != 0) {
         int amtleft;
 
@@ -1874,6 +2035,61 @@ virStorageBackendUpdateVolInfo(virStorageVolDef *vol,
     return 0;
 }
 
+static void
+storageBackendStatToTimestamps(virStorageTimestamps *timestamps,
+                               const struct stat *sb)
+{
+#ifdef __APPLE__
+    timestamps->atime = sb->st_atimespec;
+    timestamps->btime = sb->st_birthtimespec;
+    timestamps->ctime = sb->st_ctimespec;
+    timestamps->mtime = sb->st_mtimespec;
+#else /* ! __APPLE__ */
+    timestamps->atime = sb->st_atim;
+# ifdef __linux__
+    timestamps->btime = (struct timespec){0, 0};
+# else /* ! __linux__ */
+    timestamps->btime = sb->st_birthtim;
+# endif /* ! __linux__ */
+    timestamps->ctime = sb->st_ctim;
+    timestamps->mtime = sb->st_mtim;
+#endif /* ! __APPLE__ */
+}
+
+
+/*
+ * Checks whether the file at @target->path is still the same as when
+ * @target was filled in by virStorageBackendUpdateVolTargetInfoFD, i.e.,
+ * neither its contents nor its metadata were changed since then. Change
+ * time is updated on any modification of the inode including writes,
+ * ownership, permission, or security label changes.
+ */
+static bool
+storageBackendTargetUnchanged(virStorageSource *target)
+{
+    virStorageTimestamps now;
+    struct stat sb;
+
+    if (!target->path ||
+        !target->timestamps ||
+        stat(target->path, &sb) < 0 ||
+        !S_ISREG(sb.st_mode) ||
+        sb.st_size != target->physical)
+        return false;
+
+    storageBackendStatToTimestamps(&now, &sb);
+
+    if (now.mtime.tv_sec != target->timestamps->mtime.tv_sec ||
+        now.mtime.tv_nsec != target->timestamps->mtime.tv_nsec ||
+        now.ctime.tv_sec != target->timestamps->ctime.tv_sec ||
+        now.ctime.tv_nsec != target->timestamps->ctime.tv_nsec)
+        return false;
+
+    target->timestamps->atime = now.atime;
+    return true;
+}
+
+
 /*
  * virStorageBackendUpdateVolTargetInfoFD:
  * @target: target definition ptr of volume to update
@@ -1903,21 +2119,7 @@ virStorageBackendUpdateVolTargetInfoFD(virStorageSource *target,
     if (!target->timestamps)
         target->timestamps = g_new0(virStorageTimestamps, 1);
 
-#ifdef __APPLE__
-    target->timestamps->atime = sb->st_atimespec;
-    target->timestamps->btime = sb->st_birthtimespec;
-    target->timestamps->ctime = sb->st_ctimespec;
-    target->timestamps->mtime = sb->st_mtimespec;
-#else /* ! __APPLE__ */
-    target->timestamps->atime = sb->st_atim;
-# ifdef __linux__
-    target->timestamps->btime = (struct timespec){0, 0};
-# else /* ! __linux__ */
-    target->timestamps->btime = sb->st_birthtim;
-# endif /* ! __linux__ */
-    target->timestamps->ctime = sb->st_ctim;
-    target->timestamps->mtime = sb->st_mtim;
-#endif /* ! __APPLE__ */
+    storageBackendStatToTimestamps(target->timestamps, sb);
 
     target->type = VIR_STORAGE_TYPE_FILE;
 
@@ -2565,6 +2767,121 @@ storageBackendVolZeroSparseFileLocal(const char *path,
 }
 
 
+/* Size of the chunks a zero wipe is split into */
+#define VIR_STORAGE_BACKEND_WIPE_CHUNK_SIZE (64 * 1024 * 1024)
+/* Size of the buffer each wipe thread writes from */
+#define VIR_STORAGE_BACKEND_WIPE_BUFFER_SIZE (1024 * 1024)
+/* Alignment required for wiping through O_DIRECT */
+#define VIR_STORAGE_BACKEND_WIPE_ALIGN 4096
+/* Maximum number of threads wiping a single volume at once */
+#define VIR_STORAGE_BACKEND_WIPE_WORKERS 4
+
+typedef struct _virStorageBackendWipeData virStorageBackendWipeData;
+struct _virStorageBackendWipeData {
+    const char *path;
+    int fd;
+    off_t start;
+    unsigned long long len;
+    size_t buflen;
+    int nchunks;
+    int next; /* index of the next chunk to wipe, accessed atomically */
+    int failed; /* set atomically by the first failing thread */
+    virErrorPtr err;
+};
+
+
+/*
+ * Let the device zero out the range itself. BLKZEROOUT never unmaps the
+ * range, the blocks are really overwritten either by the device (WRITE
+ * ZEROES) or by the kernel. Discarding is deliberately not used here as
+ * it does not guarantee the old data to be gone.
+ *
+ * Returns true if the range was zeroed, false if it has to be written.
+ */
+static bool
+storageBackendWipeOffload(const char *path G_GNUC_UNUSED,
+                          int fd G_GNUC_UNUSED,
+                          off_t start G_GNUC_UNUSED,
+                          unsigned long long len G_GNUC_UNUSED)
+{
+#if defined(__linux__) && defined(BLKZEROOUT)
+    struct stat st;
+    uint64_t range[2] = { start, len };
+
+    if (fstat(fd, &st) < 0 || !S_ISBLK(st.st_mode))
+        return false;
+
+    if (start % 512 != 0 || len % 512 != 0)
+        return false;
+
+    if (ioctl(fd, BLKZEROOUT, range) < 0) {
+        VIR_DEBUG("BLKZEROOUT on '%s' failed, falling back to writing zeroes: %s",
+                  path, g_strerror(errno));
+        return false;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+static void
+storageBackendWipeWorker(void *opaque)
+{
+    virStorageBackendWipeData *data = opaque;
+    intptr_t alignMask = VIR_STORAGE_BACKEND_WIPE_ALIGN - 1;
+    g_autofree char *base = NULL;
+    char *buf;
+    int i;
+
+    /* O_DIRECT needs an aligned buffer */
+    base = g_new0(char, data->buflen + alignMask);
+    buf = (char *) (((intptr_t) base + alignMask) & ~alignMask);
+
+    while (!g_atomic_int_get(&data->failed) &&
+           (i = g_atomic_int_add(&data->next, 1)) < data->nchunks) {
+        unsigned long long offset = (unsigned long long)i * VIR_STORAGE_BACKEND_WIPE_CHUNK_SIZE;
+        unsigned long long remaining = MIN(VIR_STORAGE_BACKEND_WIPE_CHUNK_SIZE,
+                                           data->len - offset);
+
+        offset += data->start;
+
+        while (remaining > 0) {
+            size_t write_size = MIN(data->buflen, remaining);
+            ssize_t written = pwrite(data->fd, buf, write_size, offset);
+
+            if (written < 0 && errno == EINTR)
+                continue;
+
+            if (written <= 0) {
+                if (written == 0)
+                    errno = ENOSPC;
+
+                if (g_atomic_int_compare_and_exchange(&data->failed, 0, 1)) {
+                    virReportSystemError(errno,
+                                         _("Failed to write %zu bytes to "
+                                           "storage volume with path '%s'"),
+                                         write_size, data->path);
+                    virErrorPreserveLast(&data->err);
+                }
+                return;
+            }
+
+            offset += written;
+            remaining -= written;
+        }
+    }
+}
+
+
+/*
+ * Writes zeroes over @wipe_len bytes of @fd, either at its start or at its
+ * end if @zero_end is true. Unless the device can zero the range itself,
+ * the range is split into chunks which are written by several threads at
+ * once, bypassing the page cache if the range is suitably aligned.
+ */
 static int
 storageBackendWipeLocal(const char *path,
                         int fd,
@@ -2572,11 +2889,15 @@ storageBackendWipeLocal(const char *path,
                         size_t writebuf_length,
                         bool zero_end)
 {
-    unsigned long long remaining = 0;
     off_t size;
-    g_autofree char *writebuf = NULL;
-
-    writebuf = g_new0(char, writebuf_length);
+    virStorageBackendWipeData data = { 0 };
+    virThread workers[VIR_STORAGE_BACKEND_WIPE_WORKERS - 1];
+    size_t nworkers = 0;
+    size_t i;
+    int directFlag = virFileDirectFdFlag();
+    VIR_AUTOCLOSE directfd = -1;
+    int writefd = fd;
+    gint64 started;
 
     if (!zero_end) {
         if ((size = lseek(fd, 0, SEEK_SET)) < 0) {
@@ -2598,31 +2919,65 @@ storageBackendWipeLocal(const char *path,
 
     VIR_DEBUG("wiping start: %zd len: %llu", (ssize_t)size, wipe_len);
 
-    remaining = wipe_len;
-    while (remaining > 0) {
-        size_t write_size = MIN(writebuf_length, remaining);
-        int written = safewrite(fd, writebuf, write_size);
+    if (wipe_len == 0)
+        return 0;
 
-        if (written < 0) {
-            virReportSystemError(errno,
-                                 _("Failed to write %zu bytes to "
-                                   "storage volume with path '%s'"),
-                                 write_size, path);
+    started = g_get_monotonic_time();
 
-            return -1;
+    if (storageBackendWipeOffload(path, fd, size, wipe_len)) {
+        VIR_DEBUG("Zeroed %llu bytes of volume with path '%s' in device",
+                  wipe_len, path);
+        return 0;
+    }
+
+    if (directFlag != -1 &&
+        size % VIR_STORAGE_BACKEND_WIPE_ALIGN == 0 &&
+        wipe_len % VIR_STORAGE_BACKEND_WIPE_ALIGN == 0 &&
+        (directfd = open(path, O_WRONLY | directFlag)) >= 0)
+        writefd = directfd;
+
+    data.path = path;
+    data.fd = writefd;
+    data.start = size;
+    data.len = wipe_len;
+    data.buflen = VIR_ROUND_UP(MAX(writebuf_length,
+                                   VIR_STORAGE_BACKEND_WIPE_BUFFER_SIZE),
+                               writebuf_length);
+    data.nchunks = VIR_DIV_UP(wipe_len, VIR_STORAGE_BACKEND_WIPE_CHUNK_SIZE);
+
+    for (i = 1; i < MIN(data.nchunks, VIR_STORAGE_BACKEND_WIPE_WORKERS); i++) {
+        if (virThreadCreateFull(&workers[nworkers], true,
+                                storageBackendWipeWorker,
+                                "vol-wipe", false, &data) < 0) {
+            VIR_WARN("Failed to create volume wiping thread: %s",
+                     virGetLastErrorMessage());
+            virResetLastError();
+            break;
         }
+        nworkers++;
+    }
+
+    storageBackendWipeWorker(&data);
 
-        remaining -= written;
+    for (i = 0; i < nworkers; i++)
+        virThreadJoin(&workers[i]);
+
+    if (data.failed) {
+        virErrorRestore(&data.err);
+        return -1;
     }
 
-    if (virFileDataSync(fd) < 0) {
+    if (virFileDataSync(writefd) < 0) {
         virReportSystemError(errno,
                              _("cannot sync data to volume with path '%s'"),
                              path);
         return -1;
     }
 
-    VIR_DEBUG("Wrote %llu bytes to volume with path '%s'", wipe_len, path);
+    VIR_DEBUG("Wrote %llu bytes to volume with path '%s' using %zu threads%s "
+              "in %lld ms", wipe_len, path, nworkers + 1,
+              writefd == directfd ? " and O_DIRECT" : "",
+              (long long)(g_get_monotonic_time() - started) / 1000);
 
     return 0;
 }
@@ -3544,9 +3899,146 @@ virStorageBackendRefreshVolTargetUpdate(virStorageVolDef *vol)
 }
 
 
+/*
+ * Returns the definition of volume @name found by the previous refresh of
+ * @pool if the image it describes did not change since then, NULL
+ * otherwise. This avoids opening and probing every image in large pools.
+ */
+static virStorageVolDef *
+storageBackendRefreshLocalReuseVol(virStoragePoolObj *pool,
+                                   const char *name,
+                                   const char *path)
+{
+    g_autoptr(virStorageVolDef) vol = NULL;
+    virStorageSource *backing;
+
+    if (!(vol = virStoragePoolObjTakeStashedVol(pool, name)))
+        return NULL;
+
+    /* Contents of directory based volumes may change without touching the
+     * directory itself, always probe them. */
+    if (vol->type != VIR_STORAGE_VOL_FILE ||
+        STRNEQ_NULLABLE(vol->target.path, path) ||
+        !storageBackendTargetUnchanged(&vol->target))
+        return NULL;
+
+    VIR_DEBUG("Reusing unchanged volume '%s'", path);
+
+    backing = vol->target.backingStore;
+    if (virStorageSourceHasBacking(&vol->target) &&
+        !storageBackendTargetUnchanged(backing)) {
+        ignore_value(storageBackendUpdateVolTargetInfo(VIR_STORAGE_VOL_FILE,
+                                                       backing,
+                                                       false,
+                                                       VIR_STORAGE_VOL_OPEN_DEFAULT, 0));
+        /* If this failed, the backing file is currently unavailable, an
+         * error message was raised, but we just continue as a full probe
+         * would. */
+    }
+
+    return g_steal_pointer(&vol);
+}
+
+
+/* Maximum number of threads probing volumes of a single pool at once */
+#define VIR_STORAGE_BACKEND_PROBE_WORKERS 8
+
+typedef struct _virStorageBackendProbeItem virStorageBackendProbeItem;
+struct _virStorageBackendProbeItem {
+    virStorageVolDef *vol;
+    int rc;
+    virErrorPtr err;
+};
+
+typedef struct _virStorageBackendProbeData virStorageBackendProbeData;
+struct _virStorageBackendProbeData {
+    virStorageBackendProbeItem *items;
+    int nitems;
+    int next; /* index of the next item to probe, accessed atomically */
+};
+
+
+static void
+storageBackendProbeWorker(void *opaque)
+{
+    virStorageBackendProbeData *data = opaque;
+    int i;
+
+    while ((i = g_atomic_int_add(&data->next, 1)) < data->nitems) {
+        virStorageBackendProbeItem *item = data->items + i;
+
+        if ((item->rc = virStorageBackendRefreshVolTargetUpdate(item->vol)) == -1)
+            virErrorPreserveLast(&item->err);
+    }
+}
+
+
+/*
+ * Runs @func with @opaque in up to @maxworkers threads at once, each of
+ * which is expected to pick items of @nitems from @opaque until all of them
+ * are processed. The calling thread takes part in the work too, thus
+ * failing to create a worker thread only limits parallelism.
+ */
+static void
+storageBackendRunWorkers(virThreadFunc func,
+                         void *opaque,
+                         size_t nitems,
+                         size_t maxworkers,
+                         const char *name)
+{
+    g_autofree virThread *workers = NULL;
+    size_t nworkers = 0;
+    size_t i;
+
+    if (nitems > 1 && maxworkers > 1)
+        workers = g_new0(virThread, MIN(nitems, maxworkers) - 1);
+
+    for (i = 1; i < MIN(nitems, maxworkers); i++) {
+        if (virThreadCreateFull(&workers[nworkers], true, func,
+                                name, false, opaque) < 0) {
+            VIR_WARN("Failed to create '%s' worker thread: %s",
+                     name, virGetLastErrorMessage());
+            virResetLastError();
+            break;
+        }
+        nworkers++;
+    }
+
+    func(opaque);
+
+    for (i = 0; i < nworkers; i++)
+        virThreadJoin(&workers[i]);
+}
+
+
+/*
+ * Probes all volumes in @items concurrently. Probing is dominated by the
+ * latency of opening and reading image headers, which is significant on
+ * network file systems, so a bounded number of threads is used to keep
+ * several requests in flight.
+ */
+static void
+storageBackendProbeVols(virStorageBackendProbeItem *items,
+                        size_t nitems)
+{
+    virStorageBackendProbeData data = {
+        .items = items,
+        .nitems = nitems,
+        .next = 0,
+    };
+
+    storageBackendRunWorkers(storageBackendProbeWorker, &data, nitems,
+                             VIR_STORAGE_BACKEND_PROBE_WORKERS, "vol-probe");
+}
+
+
 /**
  * Iterate over the pool's directory and enumerate all disk images
  * within it. This is non-recursive.
+ *
+ * Images which did not change since the previous refresh of the pool are
+ * not probed again, their definitions are reused instead. The rest is
+ * probed in parallel and added to the pool once all of them are done.
  */
 int
 virStorageBackendRefreshLocal(virStoragePoolObj *pool)
@@ -3558,46 +4050,68 @@ virStorageBackendRefreshLocal(virStoragePoolObj *pool)
     struct stat statbuf;
     int direrr;
     g_autoptr(virStorageVolDef) vol = NULL;
+    g_autofree char *path = NULL;
     VIR_AUTOCLOSE fd = -1;
     g_autoptr(virStorageSource) target = NULL;
+    g_autofree virStorageBackendProbeItem *items = NULL;
+    size_t nitems = 0;
+    size_t i;
+    int ret = -1;
 
     if (virDirOpen(&dir, def->target.path) < 0)
         return -1;
 
     while ((direrr = virDirRead(dir, &ent, def->target.path)) > 0) {
-        int err;
-
         if (virStringHasControlChars(ent->d_name)) {
             VIR_WARN("Ignoring file '%s' with control characters under '%s'",
                      ent->d_name, def->target.path);
             continue;
         }
 
+        path = g_strdup_printf("%s/%s", def->target.path, ent->d_name);
+
+        if ((vol = storageBackendRefreshLocalReuseVol(pool, ent->d_name, path))) {
+            g_clear_pointer(&path, g_free);
+
+            if (virStoragePoolObjAddVol(pool, vol) < 0)
+                goto cleanup;
+            vol = NULL;
+            continue;
+        }
+
         vol = g_new0(virStorageVolDef, 1);
 
         vol->name = g_strdup(ent->d_name);
 
         vol->type = VIR_STORAGE_VOL_FILE;
-        vol->target.path = g_strdup_printf("%s/%s", def->target.path, vol->name);
+        vol->target.path = g_steal_pointer(&path);
 
         vol->key = g_strdup(vol->target.path);
 
-        if ((err = virStorageBackendRefreshVolTargetUpdate(vol)) < 0) {
-            if (err == -2) {
-                /* Silently ignore non-regular files,
-                 * eg 'lost+found', dangling symbolic link */
-                g_clear_pointer(&vol, virStorageVolDefFree);
-                continue;
-            }
-            return -1;
+        VIR_EXPAND_N(items, nitems, 1);
+        items[nitems - 1].vol = g_steal_pointer(&vol);
+    }
+    if (direrr < 0)
+        goto cleanup;
+
+    storageBackendProbeVols(items, nitems);
+
+    for (i = 0; i < nitems; i++) {
+        if (items[i].rc == -2) {
+            /* Silently ignore non-regular files,
+             * eg 'lost+found', dangling symbolic link */
+            continue;
         }
 
-        if (virStoragePoolObjAddVol(pool, vol) < 0)
-            return -1;
-        vol = NULL;
+        if (items[i].rc < 0) {
+            virErrorRestore(&items[i].err);
+            goto cleanup;
+        }
+
+        if (virStoragePoolObjAddVol(pool, items[i].vol) < 0)
+            goto cleanup;
+        items[i].vol = NULL;
     }
-    if (direrr < 0)
-        return -1;
 
     target = virStorageSourceNew();
 
@@ -3605,25 +4119,25 @@ virStorageBackendRefreshLocal(virStoragePoolObj *pool)
         virReportSystemError(errno,
                              _("cannot open path '%s'"),
                              def->target.path);
-        return -1;
+        goto cleanup;
     }
 
     if (fstat(fd, &statbuf) < 0) {
         virReportSystemError(errno,
                              _("cannot stat path '%s'"),
                              def->target.path);
-        return -1;
+        goto cleanup;
     }
 
     if (virStorageBackendUpdateVolTargetInfoFD(target, fd, &statbuf) < 0)
-        return -1;
+        goto cleanup;
 
     /* VolTargetInfoFD doesn't update capacity correctly for the pool case */
     if (statvfs(def->target.path, &sb) < 0) {
         virReportSystemError(errno,
                              _("cannot statvfs path '%s'"),
                              def->target.path);
-        return -1;
+        goto cleanup;
     }
 
     def->capacity = ((unsigned long long)sb.f_frsize *
@@ -3638,7 +4152,14 @@ virStorageBackendRefreshLocal(virStoragePoolObj *pool)
     VIR_FREE(def->target.perms.label);
     def->target.perms.label = g_strdup(target->perms->label);
 
-    return 0;
+    ret = 0;
+
+ cleanup:
+    for (i = 0; i < nitems; i++) {
+        virStorageVolDefFree(items[i].vol);
+        virFreeError(items[i].err);
+    }
+    return ret;
 }
 
 
@@ -3664,23 +4185,96 @@ virStorageBackendSCSISerial(const char *dev,
 }
 
 
+/*
+ * Maps device nodes to the symlinks pointing to them in the stable target
+ * directory of @pool, so that LUNs don't have to scan the directory one by
+ * one. Returns NULL if the pool doesn't use a stable target path or the
+ * directory can't be read, in which case virStorageBackendStablePath has to
+ * be used.
+ */
+static GHashTable *
+virStorageBackendSCSIStablePathsNew(virStoragePoolObj *pool)
+{
+    virStoragePoolDef *def = virStoragePoolObjGetDef(pool);
+    g_autoptr(GHashTable) paths = NULL;
+    g_autoptr(DIR) dh = NULL;
+    struct dirent *dent;
+
+    if (!virStorageBackendPoolPathIsStable(def->target.path))
+        return NULL;
+
+    if (virDirOpenQuiet(&dh, def->target.path) < 0)
+        return NULL;
+
+    paths = virHashNew(g_free);
+
+    while (virDirRead(dh, &dent, NULL) > 0) {
+        g_autofree char *stablepath = NULL;
+        g_autofree char *key = NULL;
+        struct stat sb;
+
+        stablepath = g_strdup_printf("%s/%s", def->target.path, dent->d_name);
+
+        if (stat(stablepath, &sb) < 0)
+            continue;
+
+        key = g_strdup_printf("%llu:%llu",
+                              (unsigned long long) sb.st_dev,
+                              (unsigned long long) sb.st_ino);
+
+        /* virStorageBackendStablePath picks the first link in
+         * directory order, do the same */
+        if (!g_hash_table_contains(paths, key))
+            g_hash_table_insert(paths, g_steal_pointer(&key),
+                                g_steal_pointer(&stablepath));
+    }
+
+    return g_steal_pointer(&paths);
+}
+
+
+static char *
+virStorageBackendSCSIStablePath(virStoragePoolObj *pool,
+                                GHashTable *stablePaths,
+                                const char *devpath)
+{
+    g_autofree char *key = NULL;
+    const char *stablepath;
+    struct stat sb;
+
+    if (stablePaths && stat(devpath, &sb) == 0) {
+        key = g_strdup_printf("%llu:%llu",
+                              (unsigned long long) sb.st_dev,
+                              (unsigned long long) sb.st_ino);
+
+        if ((stablepath = g_hash_table_lookup(stablePaths, key)))
+            return g_strdup(stablepath);
+    }
+
+    /* The link may not have shown up yet, wait for it */
+    return virStorageBackendStablePath(pool, devpath, true);
+}
+
+
 /*
  * Attempt to create a new LUN
  *
  * Returns:
  *
- *  0  => Success
+ *  0  => Success, @volret is filled in
  *  -1 => Failure due to some sort of OOM or other fatal issue found when
  *        attempting to get/update information about a found volume
  *  -2 => Failure to find a stable path, not fatal, caller can try another
  */
 static int
 virStorageBackendSCSINewLun(virStoragePoolObj *pool,
+                            GHashTable *stablePaths,
                             uint32_t host G_GNUC_UNUSED,
                             uint32_t bus,
                             uint32_t target,
                             uint32_t lun,
-                            const char *dev)
+                            const char *dev,
+                            virStorageVolDef **volret)
 {
     virStoragePoolDef *def = virStoragePoolObjGetDef(pool);
     int retval = -1;
@@ -3718,15 +4312,10 @@ virStorageBackendSCSINewLun(virStoragePoolObj *pool,
 
     VIR_DEBUG("Trying to create volume for '%s'", devpath);
 
-    /* Now figure out the stable path
-     *
-     * XXX this method is O(N) because it scans the pool target
-     * dir every time its run. Should figure out a more efficient
-     * way of doing this...
-     */
-    if ((vol->target.path = virStorageBackendStablePath(pool,
-                                                        devpath,
-                                                        true)) == NULL)
+    /* Now figure out the stable path */
+    if ((vol->target.path = virStorageBackendSCSIStablePath(pool,
+                                                            stablePaths,
+                                                            devpath)) == NULL)
         return -1;
 
     if (STREQ(devpath, vol->target.path) &&
@@ -3751,13 +4340,7 @@ virStorageBackendSCSINewLun(virStoragePoolObj *pool,
     if (!vol->key)
         return -1;
 
-    def->capacity += vol->target.capacity;
-    def->allocation += vol->target.allocation;
-
-    if (virStoragePoolObjAddVol(pool, vol) < 0)
-        return -1;
-    vol = NULL;
-
+    *volret = g_steal_pointer(&vol);
     return 0;
 }
 
@@ -3940,10 +4523,12 @@ getDeviceType(uint32_t host,
  */
 static int
 processLU(virStoragePoolObj *pool,
+          GHashTable *stablePaths,
           uint32_t host,
           uint32_t bus,
           uint32_t target,
-          uint32_t lun)
+          uint32_t lun,
+          virStorageVolDef **vol)
 {
     int retval = -1;
     int device_type;
@@ -3974,8 +4559,9 @@ processLU(virStoragePoolObj *pool,
         return retval;
     }
 
-    retval = virStorageBackendSCSINewLun(pool, host, bus, target, lun,
-                                         block_device);
+    retval = virStorageBackendSCSINewLun(pool, stablePaths,
+                                         host, bus, target, lun,
+                                         block_device, vol);
     if (retval < 0) {
         VIR_DEBUG("Failed to create new storage volume for %u:%u:%u:%u",
                   host, bus, target, lun);
@@ -3989,18 +4575,75 @@ processLU(virStoragePoolObj *pool,
 }
 
 
+/* Maximum number of threads processing LUs of a single SCSI host at once */
+#define VIR_STORAGE_BACKEND_SCSI_WORKERS 8
+
+typedef struct _virStorageBackendSCSILU virStorageBackendSCSILU;
+struct _virStorageBackendSCSILU {
+    uint32_t bus;
+    uint32_t target;
+    uint32_t lun;
+    virStorageVolDef *vol;
+    int rc;
+    virErrorPtr err;
+};
+
+typedef struct _virStorageBackendSCSIScanData virStorageBackendSCSIScanData;
+struct _virStorageBackendSCSIScanData {
+    virStoragePoolObj *pool;
+    GHashTable *stablePaths;
+    uint32_t host;
+    virStorageBackendSCSILU *lus;
+    int nlus;
+    int next; /* index of the next LU to process, accessed atomically */
+};
+
+
+static void
+virStorageBackendSCSIScanWorker(void *opaque)
+{
+    virStorageBackendSCSIScanData *data = opaque;
+    int i;
+
+    while ((i = g_atomic_int_add(&data->next, 1)) < data->nlus) {
+        virStorageBackendSCSILU *lu = data->lus + i;
+
+        lu->rc = processLU(data->pool, data->stablePaths, data->host,
+                           lu->bus, lu->target, lu->lun, &lu->vol);
+        if (lu->rc == -1)
+            virErrorPreserveLast(&lu->err);
+    }
+}
+
+
+/*
+ * Finds all LUs of SCSI host @scanhost and adds a volume for each disk
+ * among them to @pool. Processing a LU is dominated by waiting for the
+ * device, e.g. to read its serial number, so several LUs are processed
+ * at once. Volumes are added in the order the LUs were found.
+ *
+ * Returns the number of volumes added or -1 on error.
+ */
 int
 virStorageBackendSCSIFindLUs(virStoragePoolObj *pool,
                               uint32_t scanhost)
 {
     virStoragePoolDef *def = virStoragePoolObjGetDef(pool);
-    int retval = 0;
+    int direrr;
     uint32_t bus, target, lun;
     const char *device_path = "/sys/bus/scsi/devices";
     g_autoptr(DIR) devicedir = NULL;
     struct dirent *lun_dirent = NULL;
     char devicepattern[64];
+    g_autoptr(GHashTable) stablePaths = NULL;
+    virStorageBackendSCSIScanData data = {
+        .pool = pool,
+        .host = scanhost,
+    };
+    size_t nlus = 0;
+    size_t i;
     int found = 0;
+    int ret = -1;
 
     VIR_DEBUG("Discovering LUs on host %u", scanhost);
 
@@ -4011,9 +4654,7 @@ virStorageBackendSCSIFindLUs(virStoragePoolObj *pool,
 
     g_snprintf(devicepattern, sizeof(devicepattern), "%u:%%u:%%u:%%u\n", scanhost);
 
-    while ((retval = virDirRead(devicedir, &lun_dirent, device_path)) > 0) {
-        int rc;
-
+    while ((direrr = virDirRead(devicedir, &lun_dirent, device_path)) > 0) {
         if (sscanf(lun_dirent->d_name, devicepattern,
                    &bus, &target, &lun) != 3) {
             continue;
@@ -4021,21 +4662,53 @@ virStorageBackendSCSIFindLUs(virStoragePoolObj *pool,
 
         VIR_DEBUG("Found possible LU '%s'", lun_dirent->d_name);
 
-        rc = processLU(pool, scanhost, bus, target, lun);
-        if (rc == -1) {
-            retval = -1;
-            break;
-        }
-        if (rc == 0)
-            found++;
+        VIR_EXPAND_N(data.lus, nlus, 1);
+        data.lus[nlus - 1].bus = bus;
+        data.lus[nlus - 1].target = target;
+        data.lus[nlus - 1].lun = lun;
     }
 
-    if (retval < 0)
-        return -1;
+    if (direrr < 0)
+        goto cleanup;
+
+    stablePaths = virStorageBackendSCSIStablePathsNew(pool);
+
+    data.nlus = nlus;
+    data.stablePaths = stablePaths;
+    storageBackendRunWorkers(virStorageBackendSCSIScanWorker, &data, nlus,
+                             VIR_STORAGE_BACKEND_SCSI_WORKERS, "scsi-scan");
+
+    for (i = 0; i < nlus; i++) {
+        virStorageBackendSCSILU *lu = data.lus + i;
+
+        if (lu->rc == -1) {
+            virErrorRestore(&lu->err);
+            goto cleanup;
+        }
+
+        if (lu->rc < 0)
+            continue;
+
+        def->capacity += lu->vol->target.capacity;
+        def->allocation += lu->vol->target.allocation;
+
+        if (virStoragePoolObjAddVol(pool, lu->vol) < 0)
+            goto cleanup;
+        lu->vol = NULL;
+        found++;
+    }
 
     VIR_DEBUG("Found %d LUs for pool %s", found, def->name);
 
-    return found;
+    ret = found;
+
+ cleanup:
+    for (i = 0; i < nlus; i++) {
+        virStorageVolDefFree(data.lus[i].vol);
+        virFreeError(data.lus[i].err);
+    }
+    g_free(data.lus);
+    return ret;
 }
 
 
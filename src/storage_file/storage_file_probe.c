@@ -410,10 +410,13 @@ qcow2GetExtensions(const char *buf,
         return 0;
     }
 
-    if (version == 2)
+    if (version == 2) {
         extension_start = QCOW2_HDR_TOTAL_SIZE;
-    else
+    } else {
+        if (buf_size < QCOW2v3_HDR_SIZE + 4)
+            return -1;
         extension_start = virReadBufInt32BE(buf + QCOW2v3_HDR_SIZE);
+    }
 
     /*
      * Traditionally QCow2 files had a layout of
@@ -455,19 +458,22 @@ qcow2GetExtensions(const char *buf,
      *
      * Unknown extensions can be ignored by skipping
      * over "length" bytes in the data stream.
+     *
+     * All offsets and lengths come from the image itself, so
+     * each one is checked against the buffer before use.
+     * Since extension_end <= buf_size, checking against
+     * extension_end guarantees the 8 byte extension header
+     * is readable.
      */
     offset = extension_start;
-    while (offset < (buf_size-8) &&
-           offset < (extension_end-8)) {
+    while (extension_end >= 8 &&
+           offset <= (extension_end - 8)) {
         unsigned int magic = virReadBufInt32BE(buf + offset);
         unsigned int len = virReadBufInt32BE(buf + offset + 4);
 
         offset += 8;
 
-        if ((offset + len) < offset)
-            break;
-
-        if ((offset + len) > buf_size)
+        if (len > buf_size - offset)
             break;
 
         switch (magic) {
@@ -490,7 +496,8 @@ qcow2GetExtensions(const char *buf,
             return 0;
         }
 
-        offset += len;
+        /* extension data is padded to a multiple of 8 bytes */
+        offset += VIR_ROUND_UP(len, 8);
     }
 
     return 0;
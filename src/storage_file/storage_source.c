@@ -29,6 +29,8 @@
 #include "storage_file_probe.h"
 #include "storage_source.h"
 #include "storage_source_backingstore.h"
+#define LIBVIRT_STORAGE_SOURCE_PRIV_H_ALLOW
+#include "storage_source_priv.h"
 #include "viralloc.h"
 #include "virerror.h"
 #include "virfile.h"
@@ -1293,6 +1295,201 @@ virStorageSourceReportBrokenChain(int errcode,
 }
 
 
+/*
+ * Cache of image headers read while walking backing chains. Backing images
+ * are usually shared by many domains and volumes, so the same headers are
+ * read over and over when domains are started or pools refreshed. Entries
+ * are keyed by device and inode number and the user and group the image is
+ * read as, so that a hit never bypasses the permission check of the actual
+ * read. They are validated by size, modification and change time of the
+ * image before each use.
+ */
+
+/* Images modified less than this many seconds ago are not cached since a
+ * subsequent modification might not change their timestamps on file systems
+ * with coarse timestamp granularity. */
+#define VIR_STORAGE_SOURCE_HEADER_CACHE_MIN_AGE 2
+
+typedef struct _virStorageSourceHeaderCacheEntry virStorageSourceHeaderCacheEntry;
+struct _virStorageSourceHeaderCacheEntry {
+    off_t size;
+    struct timespec mtime;
+    struct timespec ctime;
+
+    char *buf;
+    size_t len;
+};
+
+static virMutex virStorageSourceHeaderCacheLock = VIR_MUTEX_INITIALIZER;
+/* "dev:ino:uid:gid" -> virStorageSourceHeaderCacheEntry */
+static GHashTable *virStorageSourceHeaderCache;
+/* keys of cache entries in the order they were added */
+static GQueue virStorageSourceHeaderCacheKeys = G_QUEUE_INIT;
+static unsigned long long virStorageSourceHeaderCacheHits;
+static unsigned long long virStorageSourceHeaderCacheMisses;
+
+
+static void
+virStorageSourceHeaderCacheEntryFree(void *opaque)
+{
+    virStorageSourceHeaderCacheEntry *entry = opaque;
+
+    g_free(entry->buf);
+    g_free(entry);
+}
+
+
+static void
+virStorageSourceHeaderCacheStatTimes(const struct stat *st,
+                                     struct timespec *mtime,
+                                     struct timespec *ctime)
+{
+#ifdef __APPLE__
+    *mtime = st->st_mtimespec;
+    *ctime = st->st_ctimespec;
+#else /* ! __APPLE__ */
+    *mtime = st->st_mtim;
+    *ctime = st->st_ctim;
+#endif /* ! __APPLE__ */
+}
+
+
+/*
+ * Returns the cache key of the image @src read as @uid:@gid and fills @st
+ * with its attributes, or NULL if the image can't be cached.
+ */
+char *
+virStorageSourceHeaderCacheKey(virStorageSource *src,
+                               uid_t uid,
+                               gid_t gid,
+                               struct stat *st)
+{
+    if (virStorageSourceGetActualType(src) != VIR_STORAGE_TYPE_FILE ||
+        virStorageSourceStat(src, st) < 0 ||
+        !S_ISREG(st->st_mode))
+        return NULL;
+
+    return g_strdup_printf("%llu:%llu:%u:%u",
+                           (unsigned long long)st->st_dev,
+                           (unsigned long long)st->st_ino,
+                           (unsigned int)uid, (unsigned int)gid);
+}
+
+
+/*
+ * Copies the cached header of the image identified by @key into @buf if the
+ * image did not change since it was cached. Returns the length of the
+ * header or -1 on cache miss.
+ */
+ssize_t
+virStorageSourceHeaderCacheLookup(const char *key,
+                                  const struct stat *st,
+                                  char **buf)
+{
+    virStorageSourceHeaderCacheEntry *entry;
+    struct timespec mtime;
+    struct timespec ctime;
+    VIR_LOCK_GUARD lock = virLockGuardLock(&virStorageSourceHeaderCacheLock);
+
+    virStorageSourceHeaderCacheStatTimes(st, &mtime, &ctime);
+
+    if (!virStorageSourceHeaderCache ||
+        !(entry = g_hash_table_lookup(virStorageSourceHeaderCache, key)) ||
+        entry->size != st->st_size ||
+        entry->mtime.tv_sec != mtime.tv_sec ||
+        entry->mtime.tv_nsec != mtime.tv_nsec ||
+        entry->ctime.tv_sec != ctime.tv_sec ||
+        entry->ctime.tv_nsec != ctime.tv_nsec) {
+        virStorageSourceHeaderCacheMisses++;
+        VIR_DEBUG("header cache miss for '%s': hits=%llu misses=%llu",
+                  key, virStorageSourceHeaderCacheHits,
+                  virStorageSourceHeaderCacheMisses);
+        return -1;
+    }
+
+    virStorageSourceHeaderCacheHits++;
+    VIR_DEBUG("header cache hit for '%s': hits=%llu misses=%llu",
+              key, virStorageSourceHeaderCacheHits,
+              virStorageSourceHeaderCacheMisses);
+
+    *buf = g_new0(char, entry->len);
+    memcpy(*buf, entry->buf, entry->len);
+    return entry->len;
+}
+
+
+/*
+ * Caches @len bytes of header @buf of the image identified by @key with
+ * attributes @st. Takes ownership of @key.
+ */
+void
+virStorageSourceHeaderCacheAdd(char *key,
+                               const struct stat *st,
+                               const char *buf,
+                               size_t len)
+{
+    g_autofree char *stolenKey = key;
+    virStorageSourceHeaderCacheEntry *entry;
+    struct timespec mtime;
+    struct timespec ctime;
+    time_t now = time(NULL);
+    VIR_LOCK_GUARD lock = virLockGuardLock(&virStorageSourceHeaderCacheLock);
+
+    virStorageSourceHeaderCacheStatTimes(st, &mtime, &ctime);
+
+    if (now - mtime.tv_sec < VIR_STORAGE_SOURCE_HEADER_CACHE_MIN_AGE ||
+        now - ctime.tv_sec < VIR_STORAGE_SOURCE_HEADER_CACHE_MIN_AGE)
+        return;
+
+    if (!virStorageSourceHeaderCache) {
+        virStorageSourceHeaderCache = g_hash_table_new_full(g_str_hash,
+                                                            g_str_equal,
+                                                            g_free,
+                                                            virStorageSourceHeaderCacheEntryFree);
+    }
+
+    if (g_hash_table_contains(virStorageSourceHeaderCache, stolenKey)) {
+        GList *link = g_queue_find_custom(&virStorageSourceHeaderCacheKeys,
+                                          stolenKey, (GCompareFunc) strcmp);
+
+        g_queue_delete_link(&virStorageSourceHeaderCacheKeys, link);
+        g_hash_table_remove(virStorageSourceHeaderCache, stolenKey);
+    }
+
+    while (g_queue_get_length(&virStorageSourceHeaderCacheKeys) >=
+           VIR_STORAGE_SOURCE_HEADER_CACHE_SIZE) {
+        char *oldest = g_queue_pop_head(&virStorageSourceHeaderCacheKeys);
+
+        g_hash_table_remove(virStorageSourceHeaderCache, oldest);
+    }
+
+    entry = g_new0(virStorageSourceHeaderCacheEntry, 1);
+    entry->size = st->st_size;
+    entry->mtime = mtime;
+    entry->ctime = ctime;
+    entry->buf = g_new0(char, len);
+    memcpy(entry->buf, buf, len);
+    entry->len = len;
+
+    /* the queue shares the key with the hash table */
+    g_queue_push_tail(&virStorageSourceHeaderCacheKeys, stolenKey);
+    g_hash_table_insert(virStorageSourceHeaderCache,
+                        g_steal_pointer(&stolenKey), entry);
+}
+
+
+void
+virStorageSourceHeaderCacheClear(void)
+{
+    VIR_LOCK_GUARD lock = virLockGuardLock(&virStorageSourceHeaderCacheLock);
+
+    g_queue_clear(&virStorageSourceHeaderCacheKeys);
+    g_clear_pointer(&virStorageSourceHeaderCache, g_hash_table_unref);
+    virStorageSourceHeaderCacheHits = 0;
+    virStorageSourceHeaderCacheMisses = 0;
+}
+
+
 static int
 virStorageSourceGetMetadataRecurseReadHeader(virStorageSource *src,
                                              virStorageSource *parent,
@@ -1303,6 +1500,8 @@ virStorageSourceGetMetadataRecurseReadHeader(virStorageSource *src,
 {
     int ret = -1;
     ssize_t len;
+    struct stat st;
+    g_autofree char *cacheKey = NULL;
 
     if (virStorageSourceIsFD(src)) {
         if (!src->fdtuple) {
@@ -1327,9 +1526,19 @@ virStorageSourceGetMetadataRecurseReadHeader(virStorageSource *src,
         goto cleanup;
     }
 
+    if ((cacheKey = virStorageSourceHeaderCacheKey(src, uid, gid, &st)) &&
+        (len = virStorageSourceHeaderCacheLookup(cacheKey, &st, buf)) >= 0) {
+        *headerLen = len;
+        ret = 0;
+        goto cleanup;
+    }
+
     if ((len = virStorageSourceRead(src, 0, VIR_STORAGE_MAX_HEADER, buf)) < 0)
         goto cleanup;
 
+    if (cacheKey)
+        virStorageSourceHeaderCacheAdd(g_steal_pointer(&cacheKey), &st, *buf, len);
+
     *headerLen = len;
     ret = 0;
 
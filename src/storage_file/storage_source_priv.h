@@ -0,0 +1,50 @@
+/*
+ * storage_source_priv.h: file utility functions for FS storage backend (private)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBVIRT_STORAGE_SOURCE_PRIV_H_ALLOW
+# error "storage_source_priv.h may only be included by storage_source.c or test suites"
+#endif /* LIBVIRT_STORAGE_SOURCE_PRIV_H_ALLOW */
+
+#pragma once
+
+#include <sys/stat.h>
+
+#include "storage_source.h"
+
+/* Maximum number of image headers kept in the cache */
+#define VIR_STORAGE_SOURCE_HEADER_CACHE_SIZE 256
+
+char *
+virStorageSourceHeaderCacheKey(virStorageSource *src,
+                               uid_t uid,
+                               gid_t gid,
+                               struct stat *st);
+
+ssize_t
+virStorageSourceHeaderCacheLookup(const char *key,
+                                  const struct stat *st,
+                                  char **buf);
+
+void
+virStorageSourceHeaderCacheAdd(char *key,
+                               const struct stat *st,
+                               const char *buf,
+                               size_t len);
+
+void
+virStorageSourceHeaderCacheClear(void);
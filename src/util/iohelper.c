@@ -51,11 +51,29 @@ usage(int status)
     exit(status);
 }
 
+static size_t
+iohelperGetEnvSize(const char *name)
+{
+    const char *value = getenv(name);
+    unsigned long long ret = 0;
+
+    if (value &&
+        (virStrToLong_ullp(value, NULL, 10, &ret) < 0 || ret > SIZE_MAX)) {
+        fprintf(stderr, _("%s: malformed %s value %s"),
+                program_name, name, value);
+        exit(EXIT_FAILURE);
+    }
+
+    return ret;
+}
+
 int
 main(int argc, char **argv)
 {
     const char *path;
     int fd = -1;
+    size_t buflen;
+    size_t nbufs;
 
     program_name = argv[0];
 
@@ -79,7 +97,11 @@ main(int argc, char **argv)
         usage(EXIT_FAILURE);
     }
 
-    if (fd < 0 || virFileDiskCopy(fd, path, -1, "stdio") < 0)
+    /* Optional tuning of the copy pipeline, 0 means default */
+    buflen = iohelperGetEnvSize("LIBVIRT_IOHELPER_BUFFER_SIZE");
+    nbufs = iohelperGetEnvSize("LIBVIRT_IOHELPER_BUFFER_COUNT");
+
+    if (fd < 0 || virFileDiskCopyFull(fd, path, -1, "stdio", buflen, nbufs) < 0)
         goto error;
 
     return 0;
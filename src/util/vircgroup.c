@@ -591,6 +591,77 @@ virCgroupGetValueStr(virCgroup *group,
 }
 
 
+/**
+ * virCgroupGetValueKeyedU64:
+ * @group: the cgroup
+ * @controller: controller owning @key
+ * @key: name of a flat keyed file, e.g. "cpu.stat"
+ * @names: NULL terminated list of entries to look up
+ * @values: array filled with values of @names
+ *
+ * Reads a flat keyed cgroup file consisting of "name value" lines and
+ * parses it in a single pass, storing the value of each of @names into the
+ * corresponding item of @values.
+ *
+ * Returns 0 on success, -1 on error or if any of @names is missing.
+ */
+int
+virCgroupGetValueKeyedU64(virCgroup *group,
+                          int controller,
+                          const char *key,
+                          const char *const *names,
+                          unsigned long long *values)
+{
+    g_autofree char *str = NULL;
+    g_autofree bool *found = NULL;
+    size_t nnames = g_strv_length((char **) names);
+    char *line;
+    char *next;
+    size_t i;
+
+    if (virCgroupGetValueStr(group, controller, key, &str) < 0)
+        return -1;
+
+    found = g_new0(bool, nnames);
+
+    for (line = str; line && *line; line = next) {
+        char *value;
+
+        if ((next = strchr(line, '\n')))
+            *next++ = '\0';
+
+        if (!(value = strchr(line, ' ')))
+            continue;
+        *value++ = '\0';
+
+        for (i = 0; i < nnames; i++) {
+            if (found[i] || STRNEQ(line, names[i]))
+                continue;
+
+            if (virStrToLong_ull(value, NULL, 10, &values[i]) < 0) {
+                virReportError(VIR_ERR_INTERNAL_ERROR,
+                               _("Failed to parse value '%s' of '%s' in '%s'"),
+                               value, line, key);
+                return -1;
+            }
+
+            found[i] = true;
+            break;
+        }
+    }
+
+    for (i = 0; i < nnames; i++) {
+        if (!found[i]) {
+            virReportError(VIR_ERR_INTERNAL_ERROR,
+                           _("Cannot find '%s' in '%s'"), names[i], key);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
 int
 virCgroupGetValueForBlkDev(const char *str,
                            const char *path,
@@ -2446,31 +2517,29 @@ virCgroupGetDomainTotalCpuStats(virCgroup *group,
                                 int nparams)
 {
     unsigned long long cpu_time;
+    unsigned long long user;
+    unsigned long long sys;
     int ret;
 
     if (nparams == 0) /* return supported number of params */
         return CGROUP_NB_TOTAL_CPU_STAT_PARAM;
-    /* entry 0 is cputime */
-    ret = virCgroupGetCpuacctUsage(group, &cpu_time);
+
+    if (nparams > 1)
+        ret = virCgroupGetCpuacctStats(group, &cpu_time, &user, &sys);
+    else
+        ret = virCgroupGetCpuacctUsage(group, &cpu_time);
+
     if (ret < 0) {
         virReportSystemError(-ret, "%s", _("unable to get cpu account"));
         return -1;
     }
 
+    /* entry 0 is cputime */
     if (virTypedParameterAssign(&params[0], VIR_DOMAIN_CPU_STATS_CPUTIME,
                                 VIR_TYPED_PARAM_ULLONG, cpu_time) < 0)
         return -1;
 
     if (nparams > 1) {
-        unsigned long long user;
-        unsigned long long sys;
-
-        ret = virCgroupGetCpuacctStat(group, &user, &sys);
-        if (ret < 0) {
-            virReportSystemError(-ret, "%s", _("unable to get cpu account"));
-            return -1;
-        }
-
         if (virTypedParameterAssign(&params[1],
                                     VIR_DOMAIN_CPU_STATS_USERTIME,
                                     VIR_TYPED_PARAM_ULLONG, user) < 0)
@@ -2897,6 +2966,40 @@ virCgroupGetCpuacctStat(virCgroup *group, unsigned long long *user,
 }
 
 
+/**
+ * virCgroupGetCpuacctStats:
+ * @group: the cgroup
+ * @usage: filled with total CPU time in nanoseconds
+ * @user: filled with user CPU time in nanoseconds
+ * @sys: filled with system CPU time in nanoseconds
+ *
+ * Equivalent to calling both virCgroupGetCpuacctUsage() and
+ * virCgroupGetCpuacctStat(), but reads the underlying file only once if the
+ * backend keeps all the values together.
+ *
+ * Returns 0 on success, -1 on error.
+ */
+int
+virCgroupGetCpuacctStats(virCgroup *group,
+                         unsigned long long *usage,
+                         unsigned long long *user,
+                         unsigned long long *sys)
+{
+    virCgroup *parent = virCgroupGetNested(group);
+    virCgroupBackend *backend;
+
+    backend = virCgroupBackendForController(parent, VIR_CGROUP_CONTROLLER_CPUACCT);
+
+    if (backend && backend->getCpuacctStats)
+        return backend->getCpuacctStats(parent, usage, user, sys);
+
+    if (virCgroupGetCpuacctUsage(group, usage) < 0)
+        return -1;
+
+    return virCgroupGetCpuacctStat(group, user, sys);
+}
+
+
 int
 virCgroupSetFreezerState(virCgroup *group, const char *state)
 {
@@ -3707,6 +3810,18 @@ virCgroupGetCpuacctStat(virCgroup *group G_GNUC_UNUSED,
 }
 
 
+int
+virCgroupGetCpuacctStats(virCgroup *group G_GNUC_UNUSED,
+                         unsigned long long *usage G_GNUC_UNUSED,
+                         unsigned long long *user G_GNUC_UNUSED,
+                         unsigned long long *sys G_GNUC_UNUSED)
+{
+    virReportSystemError(ENOSYS, "%s",
+                         _("Control groups not supported on this platform"));
+    return -1;
+}
+
+
 int
 virCgroupGetDomainTotalCpuStats(virCgroup *group G_GNUC_UNUSED,
                                 virTypedParameterPtr params G_GNUC_UNUSED,
@@ -3968,6 +4083,18 @@ virCgroupSetupCpuPeriodQuota(virCgroup *cgroup,
     if (period == 0 && quota == 0)
         return 0;
 
+    if (period && quota) {
+        virCgroup *parent = virCgroupGetNested(cgroup);
+        virCgroupBackend *backend;
+
+        backend = virCgroupBackendForController(parent, VIR_CGROUP_CONTROLLER_CPU);
+
+        /* Setting both values at once needs neither reading the old period
+         * nor rolling it back. */
+        if (backend && backend->setCpuCfsPeriodQuota)
+            return backend->setCpuCfsPeriodQuota(parent, period, quota);
+    }
+
     if (period) {
         /* get old period, and we can rollback if set quota failed */
         if (virCgroupGetCpuCfsPeriod(cgroup, &old_period) < 0)
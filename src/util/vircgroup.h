@@ -252,6 +252,8 @@ int virCgroupGetCpuacctUsage(virCgroup *group, unsigned long long *usage);
 int virCgroupGetCpuacctPercpuUsage(virCgroup *group, char **usage);
 int virCgroupGetCpuacctStat(virCgroup *group, unsigned long long *user,
                             unsigned long long *sys);
+int virCgroupGetCpuacctStats(virCgroup *group, unsigned long long *usage,
+                             unsigned long long *user, unsigned long long *sys);
 
 int virCgroupSetFreezerState(virCgroup *group, const char *state);
 int virCgroupGetFreezerState(virCgroup *group, char **state);
@@ -321,6 +321,11 @@ typedef int
 (*virCgroupGetCpuCfsQuotaCB)(virCgroup *group,
                              long long *cfs_quota);
 
+typedef int
+(*virCgroupSetCpuCfsPeriodQuotaCB)(virCgroup *group,
+                                   unsigned long long cfs_period,
+                                   long long cfs_quota);
+
 typedef bool
 (*virCgroupSupportsCpuBWCB)(virCgroup *cgroup);
 
@@ -337,6 +342,12 @@ typedef int
                              unsigned long long *user,
                              unsigned long long *sys);
 
+typedef int
+(*virCgroupGetCpuacctStatsCB)(virCgroup *group,
+                              unsigned long long *usage,
+                              unsigned long long *user,
+                              unsigned long long *sys);
+
 typedef int
 (*virCgroupSetFreezerStateCB)(virCgroup *group,
                               const char *state);
@@ -433,11 +444,15 @@ struct _virCgroupBackend {
     virCgroupGetCpuCfsPeriodCB getCpuCfsPeriod;
     virCgroupSetCpuCfsQuotaCB setCpuCfsQuota;
     virCgroupGetCpuCfsQuotaCB getCpuCfsQuota;
+    /* optional, sets both values at once */
+    virCgroupSetCpuCfsPeriodQuotaCB setCpuCfsPeriodQuota;
     virCgroupSupportsCpuBWCB supportsCpuBW;
 
     virCgroupGetCpuacctUsageCB getCpuacctUsage;
     virCgroupGetCpuacctPercpuUsageCB getCpuacctPercpuUsage;
     virCgroupGetCpuacctStatCB getCpuacctStat;
+    /* optional, gets usage and stat at once */
+    virCgroupGetCpuacctStatsCB getCpuacctStats;
 
     virCgroupSetFreezerStateCB setFreezerState;
     virCgroupGetFreezerStateCB getFreezerState;
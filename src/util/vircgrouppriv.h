@@ -50,6 +50,8 @@ typedef struct _virCgroupV2Devices virCgroupV2Devices;
 
 struct _virCgroupV2Controller {
     int controllers;
+    /* controllers known to be enabled in cgroup.subtree_control */
+    int subtreeControllers;
     char *mountPoint;
     char *placement;
     virCgroupV2Devices devices;
@@ -89,6 +91,12 @@ int virCgroupGetValueStr(virCgroup *group,
                          const char *key,
                          char **value);
 
+int virCgroupGetValueKeyedU64(virCgroup *group,
+                              int controller,
+                              const char *key,
+                              const char *const *names,
+                              unsigned long long *values);
+
 int virCgroupSetValueU64(virCgroup *group,
                          int controller,
                          const char *key,
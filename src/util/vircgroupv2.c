@@ -388,6 +388,13 @@ virCgroupV2EnableController(virCgroup *group,
     g_autofree char *val = NULL;
     g_autofree char *path = NULL;
 
+    /* Every thread cgroup would enable the same controllers in the domain
+     * cgroup again, so remember what was already done. */
+    if (parent->unified.subtreeControllers & (1 << controller)) {
+        group->unified.controllers |= 1 << controller;
+        return 0;
+    }
+
     val = g_strdup_printf("+%s", virCgroupV2ControllerTypeToString(controller));
 
     if (virCgroupPathOfController(parent, controller,
@@ -404,6 +411,7 @@ virCgroupV2EnableController(virCgroup *group,
         return -2;
     }
 
+    parent->unified.subtreeControllers |= 1 << controller;
     group->unified.controllers |= 1 << controller;
 
     return 0;
@@ -1623,6 +1631,46 @@ virCgroupV2SetCpuCfsQuota(virCgroup *group,
 }
 
 
+static int
+virCgroupV2SetCpuCfsPeriodQuota(virCgroup *group,
+                                unsigned long long cfs_period,
+                                long long cfs_quota)
+{
+    g_autofree char *value = NULL;
+
+    if (cfs_period < VIR_CGROUP_CPU_PERIOD_MIN ||
+        cfs_period > VIR_CGROUP_CPU_PERIOD_MAX) {
+        virReportError(VIR_ERR_INVALID_ARG,
+                       _("cfs_period '%llu' must be in range (%llu, %llu)"),
+                       cfs_period,
+                       VIR_CGROUP_CPU_PERIOD_MIN,
+                       VIR_CGROUP_CPU_PERIOD_MAX);
+        return -1;
+    }
+
+    if (cfs_quota >= 0 &&
+        (cfs_quota < VIR_CGROUP_CPU_QUOTA_MIN ||
+         cfs_quota > VIR_CGROUP_CPU_QUOTA_MAX)) {
+        virReportError(VIR_ERR_INVALID_ARG,
+                       _("cfs_quota '%lld' must be in range (%llu, %llu)"),
+                       cfs_quota,
+                       VIR_CGROUP_CPU_QUOTA_MIN,
+                       VIR_CGROUP_CPU_QUOTA_MAX);
+        return -1;
+    }
+
+    /* Both values live in 'cpu.max' so a single write is enough instead of
+     * the read-modify-write done by the separate setters. */
+    if (cfs_quota < 0 || cfs_quota == VIR_CGROUP_CPU_QUOTA_MAX)
+        value = g_strdup_printf("max %llu", cfs_period);
+    else
+        value = g_strdup_printf("%lld %llu", cfs_quota, cfs_period);
+
+    return virCgroupSetValueStr(group, VIR_CGROUP_CONTROLLER_CPU,
+                                "cpu.max", value);
+}
+
+
 static int
 virCgroupV2GetCpuCfsQuota(virCgroup *group,
                           long long *cfs_quota)
@@ -1666,33 +1714,35 @@ virCgroupV2SupportsCpuBW(virCgroup *cgroup)
 
 
 static int
-virCgroupV2GetCpuacctUsage(virCgroup *group,
-                           unsigned long long *usage)
+virCgroupV2GetCpuacctStats(virCgroup *group,
+                           unsigned long long *usage,
+                           unsigned long long *user,
+                           unsigned long long *sys)
 {
-    g_autofree char *str = NULL;
-    char *tmp;
+    const char *names[] = { "usage_usec", "user_usec", "system_usec", NULL };
+    unsigned long long values[G_N_ELEMENTS(names) - 1] = { 0 };
 
-    if (virCgroupGetValueStr(group, VIR_CGROUP_CONTROLLER_CPUACCT,
-                             "cpu.stat", &str) < 0) {
+    if (virCgroupGetValueKeyedU64(group, VIR_CGROUP_CONTROLLER_CPUACCT,
+                                  "cpu.stat", names, values) < 0) {
         return -1;
     }
 
-    if (!(tmp = strstr(str, "usage_usec "))) {
-        virReportError(VIR_ERR_INTERNAL_ERROR,
-                       _("cannot parse cpu usage stat '%s'"), str);
-        return -1;
-    }
-    tmp += strlen("usage_usec ");
+    if (usage)
+        *usage = values[0] * 1000;
+    if (user)
+        *user = values[1] * 1000;
+    if (sys)
+        *sys = values[2] * 1000;
 
-    if (virStrToLong_ull(tmp, &tmp, 10, usage) < 0) {
-        virReportError(VIR_ERR_INTERNAL_ERROR,
-                       _("Failed to parse value '%s' as number."), tmp);
-        return -1;
-    }
+    return 0;
+}
 
-    *usage *= 1000;
 
-    return 0;
+static int
+virCgroupV2GetCpuacctUsage(virCgroup *group,
+                           unsigned long long *usage)
+{
+    return virCgroupV2GetCpuacctStats(group, usage, NULL, NULL);
 }
 
 
@@ -1701,46 +1751,7 @@ virCgroupV2GetCpuacctStat(virCgroup *group,
                           unsigned long long *user,
                           unsigned long long *sys)
 {
-    g_autofree char *str = NULL;
-    char *tmp;
-    unsigned long long userVal = 0;
-    unsigned long long sysVal = 0;
-
-    if (virCgroupGetValueStr(group, VIR_CGROUP_CONTROLLER_CPUACCT,
-                             "cpu.stat", &str) < 0) {
-        return -1;
-    }
-
-    if (!(tmp = strstr(str, "user_usec "))) {
-        virReportError(VIR_ERR_INTERNAL_ERROR,
-                       _("cannot parse cpu user stat '%s'"), str);
-        return -1;
-    }
-    tmp += strlen("user_usec ");
-
-    if (virStrToLong_ull(tmp, &tmp, 10, &userVal) < 0) {
-        virReportError(VIR_ERR_INTERNAL_ERROR,
-                       _("Failed to parse value '%s' as number."), tmp);
-        return -1;
-    }
-
-    if (!(tmp = strstr(str, "system_usec "))) {
-        virReportError(VIR_ERR_INTERNAL_ERROR,
-                       _("cannot parse cpu sys stat '%s'"), str);
-        return -1;
-    }
-    tmp += strlen("system_usec ");
-
-    if (virStrToLong_ull(tmp, &tmp, 10, &sysVal) < 0) {
-        virReportError(VIR_ERR_INTERNAL_ERROR,
-                       _("Failed to parse value '%s' as number."), tmp);
-        return -1;
-    }
-
-    *user = userVal * 1000;
-    *sys = sysVal * 1000;
-
-    return 0;
+    return virCgroupV2GetCpuacctStats(group, NULL, user, sys);
 }
 
 
@@ -1964,10 +1975,12 @@ virCgroupBackend virCgroupV2Backend = {
     .getCpuCfsPeriod = virCgroupV2GetCpuCfsPeriod,
     .setCpuCfsQuota = virCgroupV2SetCpuCfsQuota,
     .getCpuCfsQuota = virCgroupV2GetCpuCfsQuota,
+    .setCpuCfsPeriodQuota = virCgroupV2SetCpuCfsPeriodQuota,
     .supportsCpuBW = virCgroupV2SupportsCpuBW,
 
     .getCpuacctUsage = virCgroupV2GetCpuacctUsage,
     .getCpuacctStat = virCgroupV2GetCpuacctStat,
+    .getCpuacctStats = virCgroupV2GetCpuacctStats,
 
     .setCpusetMems = virCgroupV2SetCpusetMems,
     .getCpusetMems = virCgroupV2GetCpusetMems,
@@ -70,6 +70,11 @@ struct _virFDStreamMsg {
 };
 
 
+/* Maximum amount of data queued between the I/O thread and the stream.
+ * It allows the thread to read ahead (or write behind) while the other
+ * side is busy, instead of handing over a single buffer at a time. */
+# define VIR_FDSTREAM_QUEUE_MAX (4 * 1024 * 1024)
+
 /* Tunnelled migration stream support */
 typedef struct virFDStreamData virFDStreamData;
 struct virFDStreamData {
@@ -106,6 +111,7 @@ struct virFDStreamData {
     bool threadAbort;
     bool threadDoRead;
     virFDStreamMsg *msg;
+    size_t msgQueued; /* bytes of data in @msg queue */
 };
 
 static virClass *virFDStreamDataClass;
@@ -147,8 +153,11 @@ virFDStreamMsgQueuePush(virFDStreamData *fdst,
     while (*tmp)
         tmp = &(*tmp)->next;
 
+    if ((*msg)->type == VIR_FDSTREAM_MSG_TYPE_DATA)
+        fdst->msgQueued += (*msg)->stream.data.len;
+
     *tmp = g_steal_pointer(msg);
-    virCondSignal(&fdst->threadCond);
+    virCondBroadcast(&fdst->threadCond);
 
     if (safewrite(fd, &c, sizeof(c)) != sizeof(c)) {
         virReportSystemError(errno,
@@ -171,9 +180,12 @@ virFDStreamMsgQueuePop(virFDStreamData *fdst,
 
     if (tmp) {
         fdst->msg = g_steal_pointer(&tmp->next);
+
+        if (tmp->type == VIR_FDSTREAM_MSG_TYPE_DATA)
+            fdst->msgQueued -= tmp->stream.data.len;
     }
 
-    virCondSignal(&fdst->threadCond);
+    virCondBroadcast(&fdst->threadCond);
 
     if (saferead(fd, &c, sizeof(c)) != sizeof(c)) {
         virReportSystemError(errno,
@@ -431,7 +443,11 @@ virFDStreamThreadDoRead(virFDStreamData *fdst,
     int inData = 0;
     long long sectionLen = 0;
     g_autofree char *buf = NULL;
-    ssize_t got;
+    ssize_t got = -1;
+
+    /* Nothing but the queue is shared with the other side of the stream,
+     * let it consume queued data while we are reading. */
+    virObjectUnlock(fdst);
 
     if (sparse && *dataLen == 0) {
         if (isBlock) {
@@ -446,7 +462,7 @@ virFDStreamThreadDoRead(virFDStreamData *fdst,
             sectionLen = 1 * 1024 * 1024;
         } else {
             if (virFileInData(fdin, &inData, &sectionLen) < 0)
-                return -1;
+                goto cleanup;
         }
 
         if (length &&
@@ -466,7 +482,6 @@ virFDStreamThreadDoRead(virFDStreamData *fdst,
     if (sparse && *dataLen == 0) {
         msg->type = VIR_FDSTREAM_MSG_TYPE_HOLE;
         msg->stream.hole.len = sectionLen;
-        got = sectionLen;
 
         /* HACK: The message queue is one directional. So caller
          * cannot make us skip the hole. Do that for them instead. */
@@ -475,8 +490,10 @@ virFDStreamThreadDoRead(virFDStreamData *fdst,
             virReportSystemError(errno,
                                  _("unable to seek in %s"),
                                  fdinname);
-            return -1;
+            goto cleanup;
         }
+
+        got = sectionLen;
     } else {
         if (sparse &&
             buflen > *dataLen)
@@ -488,7 +505,7 @@ virFDStreamThreadDoRead(virFDStreamData *fdst,
             virReportSystemError(errno,
                                  _("Unable to read %s"),
                                  fdinname);
-            return -1;
+            goto cleanup;
         }
 
         msg->type = VIR_FDSTREAM_MSG_TYPE_DATA;
@@ -498,12 +515,70 @@ virFDStreamThreadDoRead(virFDStreamData *fdst,
             *dataLen -= got;
     }
 
-    virFDStreamMsgQueuePush(fdst, &msg, fdout, fdoutname);
+ cleanup:
+    virObjectLock(fdst);
+
+    if (got >= 0)
+        virFDStreamMsgQueuePush(fdst, &msg, fdout, fdoutname);
 
     return got;
 }
 
 
+static ssize_t
+virFDStreamThreadDoWriteHole(bool isBlock,
+                             const int fdout,
+                             const char *fdoutname,
+                             long long len)
+{
+    if (isBlock) {
+        g_autofree char * buf = NULL;
+        const size_t buflen = 1 * 1024 * 1024; /* 1MiB */
+        size_t toWrite = len;
+
+        /* While for files it's enough to lseek() and ftruncate() to create
+         * a hole which would emulate zeroes on read(), for block devices
+         * we have to write zeroes to read() zeroes. And we have to write
+         * @len bytes of zeroes. Do that in smaller chunks though.*/
+
+        buf = g_new0(char, buflen);
+
+        while (toWrite) {
+            size_t count = MIN(toWrite, buflen);
+            ssize_t r;
+
+            if ((r = safewrite(fdout, buf, count)) < 0) {
+                virReportSystemError(errno,
+                                     _("Unable to write %s"),
+                                     fdoutname);
+                return -1;
+            }
+
+            toWrite -= r;
+        }
+    } else {
+        off_t off;
+
+        off = lseek(fdout, len, SEEK_CUR);
+        if (off == (off_t) -1) {
+            virReportSystemError(errno,
+                                 _("unable to seek in %s"),
+                                 fdoutname);
+            return -1;
+        }
+
+        if (ftruncate(fdout, off) < 0) {
+            virReportSystemError(errno,
+                                 _("unable to truncate %s"),
+                                 fdoutname);
+            return -1;
+        }
+    }
+
+    return len;
+}
+
+
 static ssize_t
 virFDStreamThreadDoWrite(virFDStreamData *fdst,
                          bool sparse,
@@ -517,17 +592,23 @@ virFDStreamThreadDoWrite(virFDStreamData *fdst,
     virFDStreamMsg *msg = fdst->msg;
     bool pop = false;
 
+    /* The other side of the stream only ever appends to the queue, so
+     * the head message can be written out without holding the lock,
+     * which lets more data be queued meanwhile. */
     switch (msg->type) {
     case VIR_FDSTREAM_MSG_TYPE_DATA:
+        virObjectUnlock(fdst);
         got = safewrite(fdout,
                         msg->stream.data.buf + msg->stream.data.offset,
                         msg->stream.data.len - msg->stream.data.offset);
-        if (got < 0) {
+        if (got < 0)
             virReportSystemError(errno,
                                  _("Unable to write %s"),
                                  fdoutname);
+        virObjectLock(fdst);
+
+        if (got < 0)
             return -1;
-        }
 
         msg->stream.data.offset += got;
 
@@ -541,50 +622,13 @@ virFDStreamThreadDoWrite(virFDStreamData *fdst,
             return -1;
         }
 
-        got = msg->stream.hole.len;
-        if (isBlock) {
-            g_autofree char * buf = NULL;
-            const size_t buflen = 1 * 1024 * 1024; /* 1MiB */
-            size_t toWrite = got;
-
-            /* While for files it's enough to lseek() and ftruncate() to create
-             * a hole which would emulate zeroes on read(), for block devices
-             * we have to write zeroes to read() zeroes. And we have to write
-             * @got bytes of zeroes. Do that in smaller chunks though.*/
-
-            buf = g_new0(char, buflen);
-
-            while (toWrite) {
-                size_t count = MIN(toWrite, buflen);
-                ssize_t r;
-
-                if ((r = safewrite(fdout, buf, count)) < 0) {
-                    virReportSystemError(errno,
-                                         _("Unable to write %s"),
-                                         fdoutname);
-                    return -1;
-                }
-
-                toWrite -= r;
-            }
-        } else {
-            off_t off;
-
-            off = lseek(fdout, got, SEEK_CUR);
-            if (off == (off_t) -1) {
-                virReportSystemError(errno,
-                                     _("unable to seek in %s"),
-                                     fdoutname);
-                return -1;
-            }
+        virObjectUnlock(fdst);
+        got = virFDStreamThreadDoWriteHole(isBlock, fdout, fdoutname,
+                                           msg->stream.hole.len);
+        virObjectLock(fdst);
 
-            if (ftruncate(fdout, off) < 0) {
-                virReportSystemError(errno,
-                                     _("unable to truncate %s"),
-                                     fdoutname);
-                return -1;
-            }
-        }
+        if (got < 0)
+            return -1;
 
         pop = true;
         break;
@@ -623,7 +667,11 @@ virFDStreamThread(void *opaque)
     while (1) {
         ssize_t got;
 
-        while (doRead == (fdst->msg != NULL) &&
+        /* Readers may get ahead of the other side of the stream up to
+         * VIR_FDSTREAM_QUEUE_MAX bytes, writers wait for data. */
+        while ((doRead ?
+                fdst->msgQueued >= VIR_FDSTREAM_QUEUE_MAX :
+                fdst->msg == NULL) &&
                !fdst->threadQuit) {
             if (virCondWait(&fdst->threadCond, &fdst->parent.lock)) {
                 virReportSystemError(errno, "%s",
@@ -638,7 +686,7 @@ virFDStreamThread(void *opaque)
                 goto cleanup;
 
             /* Otherwise flush buffers and quit gracefully. */
-            if (doRead == (fdst->msg != NULL))
+            if (doRead || !fdst->msg)
                 break;
         }
 
@@ -664,6 +712,8 @@ virFDStreamThread(void *opaque)
 
  cleanup:
     fdst->threadQuit = true;
+    /* Wake up writers waiting for room in the queue */
+    virCondBroadcast(&fdst->threadCond);
     virObjectUnlock(fdst);
     virFDStreamDataDisposed = false;
     virObjectUnref(fdst);
@@ -688,7 +738,7 @@ virFDStreamJoinWorker(virFDStreamData *fdst,
 
     fdst->threadAbort = streamAbort;
     fdst->threadQuit = true;
-    virCondSignal(&fdst->threadCond);
+    virCondBroadcast(&fdst->threadCond);
 
     /* Give the thread a chance to lock the FD stream object. */
     virObjectUnlock(fdst);
@@ -826,6 +876,17 @@ static int virFDStreamWrite(virStreamPtr st, const char *bytes, size_t nbytes)
     if (fdst->thread) {
         char *buf;
 
+        /* Flow control: don't let the queue grow beyond what the thread
+         * can write out in reasonable time. */
+        while (fdst->msgQueued >= VIR_FDSTREAM_QUEUE_MAX &&
+               !fdst->threadQuit && !fdst->threadErr) {
+            if (virCondWait(&fdst->threadCond, &fdst->parent.lock) < 0) {
+                virReportSystemError(errno, "%s",
+                                     _("failed to wait on condition"));
+                goto cleanup;
+            }
+        }
+
         if (fdst->threadQuit || fdst->threadErr) {
 
             /* virStreamSend will virResetLastError possibly set
@@ -905,6 +966,7 @@ static int virFDStreamRead(virStreamPtr st, char *bytes, size_t nbytes)
 
     if (fdst->thread) {
         virFDStreamMsg *msg = NULL;
+        size_t got = 0;
 
         while (!(msg = fdst->msg)) {
             if (fdst->threadQuit || fdst->threadErr) {
@@ -942,20 +1004,39 @@ static int virFDStreamRead(virStreamPtr st, char *bytes, size_t nbytes)
             goto cleanup;
         }
 
-        if (nbytes > msg->stream.data.len - msg->stream.data.offset)
-            nbytes = msg->stream.data.len - msg->stream.data.offset;
+        /* Fill the buffer from as many queued data messages as possible,
+         * so that the caller is woken up once per buffer rather than once
+         * per message. */
+        while (msg &&
+               msg->type == VIR_FDSTREAM_MSG_TYPE_DATA &&
+               got < nbytes) {
+            size_t want = MIN(nbytes - got,
+                              msg->stream.data.len - msg->stream.data.offset);
+
+            /* An empty message marks EOF, report it by the next read */
+            if (msg->stream.data.len == 0 && got > 0)
+                break;
+
+            memcpy(bytes + got,
+                   msg->stream.data.buf + msg->stream.data.offset,
+                   want);
+
+            msg->stream.data.offset += want;
+            got += want;
 
-        memcpy(bytes,
-               msg->stream.data.buf + msg->stream.data.offset,
-               nbytes);
+            if (msg->stream.data.offset != msg->stream.data.len)
+                break;
 
-        msg->stream.data.offset += nbytes;
-        if (msg->stream.data.offset == msg->stream.data.len) {
             virFDStreamMsgQueuePop(fdst, fdst->fd, "pipe");
             virFDStreamMsgFree(msg);
+
+            if (want == 0)
+                break;
+
+            msg = fdst->msg;
         }
 
-        ret = nbytes;
+        ret = got;
 
     } else {
      retry:
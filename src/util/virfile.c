@@ -87,6 +87,7 @@
 #include "virlog.h"
 #include "virprocess.h"
 #include "virstring.h"
+#include "virthread.h"
 #include "virutil.h"
 #include "virsocket.h"
 
@@ -4567,118 +4568,362 @@ virFileSetCOW(const char *path,
 }
 
 #ifndef WIN32
+# define VIR_FILE_DISK_COPY_ALIGN (64 * 1024)
+# define VIR_FILE_DISK_COPY_BUF_SIZE (1024 * 1024)
+# define VIR_FILE_DISK_COPY_BUF_COUNT 2
+# define VIR_FILE_DISK_COPY_BUF_COUNT_MAX 64
+# define VIR_FILE_DISK_COPY_SPARSE_BLOCK 4096
+
 struct runIOParams {
     bool isBlockDev;
     bool isDirect;
     bool isWrite;
+    bool isSparse; /* skip over zero blocks instead of writing them */
     int fdin;
     const char *fdinname;
     int fdout;
     const char *fdoutname;
+    size_t buflen;
+    size_t nbufs;
 };
 
-/**
- * runIOCopy: execute the IO copy based on the passed parameters
- * @p: the IO parameters
- *
- * Execute the copy based on the passed parameters.
- *
- * Returns: size transferred, or < 0 on error.
- */
+struct runIOBuffer {
+    void *base; /* Location to be freed */
+    char *data; /* Aligned location within base */
+    ssize_t len;
+};
 
-static off_t
-runIOCopy(const struct runIOParams p)
+/* State shared between the reader thread and the writer in runIOCopy.
+ * Buffers are used as a ring: the reader fills the @count slots following
+ * @head, the writer drains them starting at @head. */
+struct runIOQueue {
+    const struct runIOParams *p;
+    virMutex lock;
+    virCond cond;
+    struct runIOBuffer *bufs;
+    size_t head;
+    size_t count;
+    bool eof;     /* reader is done, either on EOF or on error */
+    bool quit;    /* writer is done and wants the reader to stop */
+    virErrorPtr err;
+};
+
+
+static void
+runIOBufferAlloc(struct runIOBuffer *buf,
+                 size_t buflen)
 {
-    g_autofree void *base = NULL; /* Location to be freed */
-    char *buf = NULL; /* Aligned location within base */
-    size_t buflen = 1024*1024;
-    intptr_t alignMask = 64*1024 - 1;
-    off_t total = 0;
+    intptr_t alignMask = VIR_FILE_DISK_COPY_ALIGN - 1;
 
 # if WITH_POSIX_MEMALIGN
-    if (posix_memalign(&base, alignMask + 1, buflen))
+    if (posix_memalign(&buf->base, alignMask + 1, buflen))
         abort();
-    buf = base;
+    buf->data = buf->base;
 # else
-    buf = g_new0(char, buflen + alignMask);
-    base = buf;
-    buf = (char *) (((intptr_t) base + alignMask) & ~alignMask);
+    buf->base = g_new0(char, buflen + alignMask);
+    buf->data = (char *) (((intptr_t) buf->base + alignMask) & ~alignMask);
 # endif
+}
+
+
+static void
+runIOCopyReader(void *opaque)
+{
+    struct runIOQueue *q = opaque;
+    const struct runIOParams *p = q->p;
 
     while (1) {
+        struct runIOBuffer *buf = NULL;
         ssize_t got;
 
+        VIR_WITH_MUTEX_LOCK_GUARD(&q->lock) {
+            while (q->count == p->nbufs && !q->quit)
+                ignore_value(virCondWait(&q->cond, &q->lock));
+            if (q->quit)
+                return;
+            buf = &q->bufs[(q->head + q->count) % p->nbufs];
+        }
+
         /* If we read with O_DIRECT from file we can't use saferead as
          * it can lead to unaligned read after reading last bytes.
          * If we write with O_DIRECT use should use saferead so that
          * writes will be aligned.
          * In other cases using saferead reduces number of syscalls.
          */
-        if (!p.isWrite && p.isDirect) {
-            if ((got = read(p.fdin, buf, buflen)) < 0 &&
-                errno == EINTR)
-                continue;
+        if (!p->isWrite && p->isDirect) {
+            do {
+                got = read(p->fdin, buf->data, p->buflen);
+            } while (got < 0 && errno == EINTR);
         } else {
-            got = saferead(p.fdin, buf, buflen);
+            got = saferead(p->fdin, buf->data, p->buflen);
+        }
+
+        if (got < 0)
+            virReportSystemError(errno, _("Unable to read %s"), p->fdinname);
+
+        VIR_WITH_MUTEX_LOCK_GUARD(&q->lock) {
+            if (got <= 0) {
+                if (got < 0)
+                    virErrorPreserveLast(&q->err);
+                q->eof = true;
+            } else {
+                buf->len = got;
+                q->count++;
+            }
+            virCondBroadcast(&q->cond);
         }
 
-        if (got < 0) {
-            virReportSystemError(errno, _("Unable to read %s"), p.fdinname);
-            return -2;
+        if (got <= 0)
+            return;
+    }
+}
+
+
+/* Checks whether @len bytes at @data are all zero. Comparing the buffer
+ * with itself shifted by one byte lets memcmp() do the heavy lifting
+ * using whatever vector instructions the C library optimizes it for. */
+static bool
+runIOIsZero(const char *data,
+            size_t len)
+{
+    return len == 0 || (data[0] == 0 && memcmp(data, data + 1, len - 1) == 0);
+}
+
+
+/**
+ * runIOWrite: write a buffer to the output of the copy
+ * @p: the IO parameters
+ * @data: data to write
+ * @len: number of bytes at @data
+ * @hole: set to true if the write ended by skipping over zeroes
+ *
+ * When @p->isSparse is set, runs of zero blocks are skipped by seeking
+ * forward so that they stay unallocated in the output file. The caller
+ * is responsible for extending the file if it ends with a hole.
+ *
+ * Returns 0 on success, -1 on error.
+ */
+static int
+runIOWrite(const struct runIOParams *p,
+           const char *data,
+           size_t len,
+           bool *hole)
+{
+    size_t done = 0;
+
+    if (!p->isSparse) {
+        if (safewrite(p->fdout, data, len) < 0) {
+            virReportSystemError(errno, _("Unable to write %s"), p->fdoutname);
+            return -1;
+        }
+        return 0;
+    }
+
+    while (done < len) {
+        size_t blk = MIN(len - done, VIR_FILE_DISK_COPY_SPARSE_BLOCK);
+        bool zero = runIOIsZero(data + done, blk);
+        size_t run = blk;
+
+        while (done + run < len) {
+            blk = MIN(len - done - run, VIR_FILE_DISK_COPY_SPARSE_BLOCK);
+            if (runIOIsZero(data + done + run, blk) != zero)
+                break;
+            run += blk;
+        }
+
+        if (zero) {
+            if (lseek(p->fdout, run, SEEK_CUR) < 0) {
+                virReportSystemError(errno, _("Unable to seek %s"), p->fdoutname);
+                return -1;
+            }
+        } else if (safewrite(p->fdout, data + done, run) < 0) {
+            virReportSystemError(errno, _("Unable to write %s"), p->fdoutname);
+            return -1;
+        }
+
+        *hole = zero;
+        done += run;
+    }
+
+    return 0;
+}
+
+
+/**
+ * runIOCopy: execute the IO copy based on the passed parameters
+ * @p: the IO parameters
+ *
+ * Execute the copy based on the passed parameters. Reading the input is
+ * done by a separate thread into a ring of @p->nbufs buffers of @p->buflen
+ * bytes each, so that reads and writes overlap instead of alternating.
+ * With @p->isSparse, zero blocks are not written and the output file is
+ * left sparse.
+ *
+ * Returns: size transferred, or < 0 on error.
+ */
+
+static off_t
+runIOCopy(const struct runIOParams p)
+{
+    struct runIOQueue q = { .p = &p };
+    intptr_t alignMask = VIR_FILE_DISK_COPY_ALIGN - 1;
+    virThread reader;
+    unsigned long long start = g_get_monotonic_time();
+    unsigned long long elapsed;
+    off_t total = 0;
+    off_t ret = 0;
+    bool hole = false;
+    size_t i;
+
+    if (virMutexInit(&q.lock) < 0) {
+        virReportError(VIR_ERR_INTERNAL_ERROR, "%s",
+                       _("Unable to init mutex"));
+        return -1;
+    }
+
+    if (virCondInit(&q.cond) < 0) {
+        virReportSystemError(errno, "%s",
+                             _("cannot initialize condition variable"));
+        virMutexDestroy(&q.lock);
+        return -1;
+    }
+
+    q.bufs = g_new0(struct runIOBuffer, p.nbufs);
+    for (i = 0; i < p.nbufs; i++)
+        runIOBufferAlloc(&q.bufs[i], p.buflen);
+
+    if (virThreadCreateFull(&reader, true, runIOCopyReader,
+                            "iohelper-read", false, &q) < 0) {
+        virReportSystemError(errno, "%s", _("Unable to create reader thread"));
+        ret = -1;
+        goto cleanup;
+    }
+
+    while (1) {
+        struct runIOBuffer *buf = NULL;
+        ssize_t got;
+
+        VIR_WITH_MUTEX_LOCK_GUARD(&q.lock) {
+            while (q.count == 0 && !q.eof)
+                ignore_value(virCondWait(&q.cond, &q.lock));
+            if (q.count > 0)
+                buf = &q.bufs[q.head];
         }
-        if (got == 0)
+
+        if (!buf)
             break;
 
+        got = buf->len;
         total += got;
 
         /* handle last write size align in direct case */
-        if (got < buflen && p.isDirect && p.isWrite) {
+        if (got < p.buflen && p.isDirect && p.isWrite) {
             ssize_t aligned_got = (got + alignMask) & ~alignMask;
 
-            memset(buf + got, 0, aligned_got - got);
+            memset(buf->data + got, 0, aligned_got - got);
 
-            if (safewrite(p.fdout, buf, aligned_got) < 0) {
-                virReportSystemError(errno, _("Unable to write %s"), p.fdoutname);
-                return -3;
+            if (runIOWrite(&p, buf->data, aligned_got, &hole) < 0) {
+                ret = -3;
+                break;
             }
 
+            /* this also sets the right size if the file ends with a hole */
+            hole = false;
             if (!p.isBlockDev && ftruncate(p.fdout, total) < 0) {
                 virReportSystemError(errno, _("Unable to truncate %s"), p.fdoutname);
-                return -4;
+                ret = -4;
             }
 
             break;
         }
 
-        if (safewrite(p.fdout, buf, got) < 0) {
-            virReportSystemError(errno, _("Unable to write %s"), p.fdoutname);
-            return -3;
+        if (runIOWrite(&p, buf->data, got, &hole) < 0) {
+            ret = -3;
+            break;
         }
+
+        VIR_WITH_MUTEX_LOCK_GUARD(&q.lock) {
+            q.head = (q.head + 1) % p.nbufs;
+            q.count--;
+            virCondBroadcast(&q.cond);
+        }
+    }
+
+    VIR_WITH_MUTEX_LOCK_GUARD(&q.lock) {
+        q.quit = true;
+        virCondBroadcast(&q.cond);
+    }
+    virThreadJoin(&reader);
+
+    if (ret == 0 && q.err) {
+        virErrorRestore(&q.err);
+        ret = -2;
+    }
+
+    /* Skipped zeroes at the end don't extend the file by themselves */
+    if (ret == 0 && hole) {
+        off_t end;
+
+        if ((end = lseek(p.fdout, 0, SEEK_CUR)) < 0 ||
+            ftruncate(p.fdout, end) < 0) {
+            virReportSystemError(errno, _("Unable to truncate %s"), p.fdoutname);
+            ret = -4;
+        }
+    }
+
+    if (ret == 0) {
+        elapsed = g_get_monotonic_time() - start;
+        VIR_DEBUG("Copied %lld bytes from %s to %s in %llu.%03llus (%.1f MiB/s) "
+                  "using %zu buffers of %zu bytes",
+                  (long long) total, p.fdinname, p.fdoutname,
+                  elapsed / 1000000, (elapsed / 1000) % 1000,
+                  elapsed ? (double) total / 1024 / 1024 * 1000000 / elapsed : 0.0,
+                  p.nbufs, p.buflen);
+        ret = total;
     }
-    return total;
+
+ cleanup:
+    virFreeError(q.err);
+    for (i = 0; i < p.nbufs; i++)
+        g_free(q.bufs[i].base);
+    g_free(q.bufs);
+    virCondDestroy(&q.cond);
+    virMutexDestroy(&q.lock);
+    return ret;
 }
 
 /**
- * virFileDiskCopy: run IO to copy data between storage and a pipe or socket.
+ * virFileDiskCopyFull: run IO to copy data between storage and a pipe or socket.
  *
  * @disk_fd:     the already open regular file or block device
  * @disk_path:   the pathname corresponding to disk_fd (for error reporting)
  * @remote_fd:   the pipe or socket
  *               Use -1 to auto-choose between STDIN or STDOUT.
  * @remote_path: the pathname corresponding to remote_fd (for error reporting)
+ * @buflen:      size of each copy buffer, 0 for the default of 1MiB.
+ *               Rounded up to a multiple of 64KiB.
+ * @nbufs:       number of buffers in flight, 0 for the default of 2
  *
  * Note that the direction of the transfer is detected based on the @disk_fd
  * file access mode (man 2 open). Therefore @disk_fd must be opened with
  * O_RDONLY or O_WRONLY. O_RDWR is not supported.
  *
- * virFileDiskCopy always closes the file descriptor disk_fd,
+ * When writing to the end of a regular file, blocks of zeroes are skipped
+ * rather than written, leaving holes in the file.
+ *
+ * virFileDiskCopyFull always closes the file descriptor disk_fd,
  * and any error during close(2) is reported and considered a failure.
  *
  * Returns: bytes transferred or < 0 on failure.
  */
 
 off_t
-virFileDiskCopy(int disk_fd, const char *disk_path, int remote_fd, const char *remote_path)
+virFileDiskCopyFull(int disk_fd,
+                    const char *disk_path,
+                    int remote_fd,
+                    const char *remote_path,
+                    size_t buflen,
+                    size_t nbufs)
 {
     int ret = -1;
     off_t total = 0;
@@ -4702,6 +4947,10 @@ virFileDiskCopy(int disk_fd, const char *disk_path, int remote_fd, const char *r
     }
     p.isBlockDev = S_ISBLK(sb.st_mode);
     p.isDirect = O_DIRECT && (oflags & O_DIRECT);
+    p.buflen = VIR_ROUND_UP(buflen ? buflen : VIR_FILE_DISK_COPY_BUF_SIZE,
+                            VIR_FILE_DISK_COPY_ALIGN);
+    p.nbufs = MIN(nbufs ? nbufs : VIR_FILE_DISK_COPY_BUF_COUNT,
+                  VIR_FILE_DISK_COPY_BUF_COUNT_MAX);
 
     switch (oflags & O_ACCMODE) {
     case O_RDONLY:
@@ -4744,6 +4993,15 @@ virFileDiskCopy(int disk_fd, const char *disk_path, int remote_fd, const char *r
             goto cleanup;
         }
     }
+    /* Zero blocks written past the end of a regular file can be skipped,
+     * the file system reads them back as zeroes anyway. Writing anywhere
+     * else must overwrite whatever data was there before. */
+    p.isSparse = false;
+    if (p.isWrite && S_ISREG(sb.st_mode)) {
+        off_t off = lseek(disk_fd, 0, SEEK_CUR);
+
+        p.isSparse = off >= 0 && off >= sb.st_size;
+    }
     total = runIOCopy(p);
     if (total < 0)
         goto cleanup;
@@ -4770,13 +5028,29 @@ virFileDiskCopy(int disk_fd, const char *disk_path, int remote_fd, const char *r
 #else /* WIN32 */
 
 off_t
-virFileDiskCopy(int disk_fd G_GNUC_UNUSED,
-                const char *disk_path G_GNUC_UNUSED,
-                int remote_fd G_GNUC_UNUSED,
-                const char *remote_path G_GNUC_UNUSED)
+virFileDiskCopyFull(int disk_fd G_GNUC_UNUSED,
+                    const char *disk_path G_GNUC_UNUSED,
+                    int remote_fd G_GNUC_UNUSED,
+                    const char *remote_path G_GNUC_UNUSED,
+                    size_t buflen G_GNUC_UNUSED,
+                    size_t nbufs G_GNUC_UNUSED)
 {
     virReportError(VIR_ERR_INTERNAL_ERROR, "%s",
                    _("virFileDiskCopy unsupported on this platform"));
     return -1;
 }
 #endif /* WIN32 */
+
+
+/**
+ * virFileDiskCopy: run IO to copy data between storage and a pipe or socket.
+ *
+ * Same as virFileDiskCopyFull() with the default buffer size and count.
+ *
+ * Returns: bytes transferred or < 0 on failure.
+ */
+off_t
+virFileDiskCopy(int disk_fd, const char *disk_path, int remote_fd, const char *remote_path)
+{
+    return virFileDiskCopyFull(disk_fd, disk_path, remote_fd, remote_path, 0, 0);
+}
@@ -1739,6 +1739,65 @@ virProcessGetStat(pid_t pid,
 
 
 #ifdef __linux__
+/*
+ * Parse the few numeric fields virProcessGetStatInfo() cares about straight
+ * out of the /proc/.../stat line in @buf, without splitting it into
+ * separately allocated strings. The line is walked once, fields after the
+ * executable name (which may contain spaces and parentheses, hence looking
+ * for the last closing parenthesis) are counted and only the requested ones
+ * are converted.
+ */
+static int
+virProcessParseStatInfo(const char *buf,
+                        unsigned long long *utime,
+                        unsigned long long *stime,
+                        long *rss,
+                        int *cpu)
+{
+    const char *cur = strrchr(buf, ')');
+    size_t field = VIR_PROCESS_STAT_COMM + 1;
+
+    if (!cur || cur[1] != ' ')
+        return -1;
+    cur += 2;
+
+    while (*cur && field <= VIR_PROCESS_STAT_PROCESSOR) {
+        const char *next = strchr(cur, ' ');
+        char *end = NULL;
+        int rc = 0;
+
+        switch (field) {
+        case VIR_PROCESS_STAT_UTIME:
+            rc = virStrToLong_ullp(cur, &end, 10, utime);
+            break;
+        case VIR_PROCESS_STAT_STIME:
+            rc = virStrToLong_ullp(cur, &end, 10, stime);
+            break;
+        case VIR_PROCESS_STAT_RSS:
+            rc = virStrToLong_l(cur, &end, 10, rss);
+            break;
+        case VIR_PROCESS_STAT_PROCESSOR:
+            rc = virStrToLong_i(cur, &end, 10, cpu);
+            break;
+        }
+
+        if (rc < 0 || (end && *end != ' ' && *end != '\0' && *end != '\n'))
+            return -1;
+
+        if (field == VIR_PROCESS_STAT_PROCESSOR)
+            return 0;
+
+        if (!next)
+            break;
+
+        cur = next + 1;
+        field++;
+    }
+
+    return -1;
+}
+
+
 int
 virProcessGetStatInfo(unsigned long long *cpuTime,
                       unsigned long long *userTime,
@@ -1748,7 +1807,12 @@ virProcessGetStatInfo(unsigned long long *cpuTime,
                       pid_t pid,
                       pid_t tid)
 {
-    g_auto(GStrv) proc_stat = virProcessGetStat(pid, tid);
+    /* The stat line is a few hundred bytes at most, keep it on the stack
+     * as this is called for every vCPU and IOThread on each stats query. */
+    char path[64];
+    char buf[4096];
+    VIR_AUTOCLOSE fd = -1;
+    ssize_t len;
     unsigned long long utime = 0;
     unsigned long long stime = 0;
     const unsigned long long jiff2nsec = 1000ull * 1000ull * 1000ull /
@@ -1756,12 +1820,29 @@ virProcessGetStatInfo(unsigned long long *cpuTime,
     long rss = 0;
     int cpu = 0;
 
-    if (!proc_stat ||
-        virStrToLong_ullp(proc_stat[VIR_PROCESS_STAT_UTIME], NULL, 10, &utime) < 0 ||
-        virStrToLong_ullp(proc_stat[VIR_PROCESS_STAT_STIME], NULL, 10, &stime) < 0 ||
-        virStrToLong_l(proc_stat[VIR_PROCESS_STAT_RSS], NULL, 10, &rss) < 0 ||
-        virStrToLong_i(proc_stat[VIR_PROCESS_STAT_PROCESSOR], NULL, 10, &cpu) < 0) {
+    if (pid) {
+        if (tid)
+            g_snprintf(path, sizeof(path), "/proc/%d/task/%d/stat", (int)pid, (int)tid);
+        else
+            g_snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    } else {
+        if (tid)
+            g_snprintf(path, sizeof(path), "/proc/self/task/%d/stat", (int)tid);
+        else
+            g_snprintf(path, sizeof(path), "/proc/self/stat");
+    }
+
+    if ((fd = open(path, O_RDONLY)) < 0 ||
+        (len = saferead(fd, buf, sizeof(buf) - 1)) < 0) {
+        len = 0;
+    }
+    buf[len] = '\0';
+
+    if (virProcessParseStatInfo(buf, &utime, &stime, &rss, &cpu) < 0) {
         VIR_WARN("cannot parse process status data");
+        utime = stime = 0;
+        rss = 0;
+        cpu = 0;
     }
 
     utime *= jiff2nsec;
@@ -19,6 +19,8 @@
 #include <config.h>
 
 #include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
 
 #include "testutils.h"
 
@@ -26,6 +28,7 @@
 #include "datatypes.h"
 #include "virlog.h"
 #include "virfile.h"
+#include "virthread.h"
 
 #define VIR_FROM_THIS VIR_FROM_NONE
 
@@ -297,6 +300,215 @@ static int testFDStreamWriteNonblock(const void *data)
     return testFDStreamWriteCommon(data, false);
 }
 
+#define THROUGHPUT_LEN (32 * 1024 * 1024)
+#define THROUGHPUT_WRITE_CHUNK (64 * 1024)
+#define THROUGHPUT_READ_CHUNK (1024 * 1024)
+
+/* Streams a larger file through the I/O thread in both directions. Reads
+ * use a buffer larger than the messages queued by the thread, so that
+ * filling it from several messages is exercised as well. With debugging
+ * enabled the achieved throughput is printed. */
+static int testFDStreamThroughput(const void *data)
+{
+    const char *scratchdir = data;
+    g_autofree char *file = NULL;
+    g_autofree char *buf = NULL;
+    virStreamPtr st = NULL;
+    virConnectPtr conn = NULL;
+    size_t total;
+    gint64 start;
+    int ret = -1;
+
+    if (!(conn = virConnectOpen("test:///default")))
+        goto cleanup;
+
+    buf = g_new0(char, THROUGHPUT_READ_CHUNK);
+    file = g_strdup_printf("%s/throughput.data", scratchdir);
+
+    if (!(st = virStreamNew(conn, VIR_STREAM_NONBLOCK)))
+        goto cleanup;
+
+    if (virFDStreamCreateFile(st, file, 0, 0, O_WRONLY, 0600) < 0)
+        goto cleanup;
+
+    start = g_get_monotonic_time();
+    for (total = 0; total < THROUGHPUT_LEN; ) {
+        int got;
+
+        memset(buf, (total / THROUGHPUT_WRITE_CHUNK) & 0xff,
+               THROUGHPUT_WRITE_CHUNK);
+
+        if ((got = st->driver->streamSend(st, buf, THROUGHPUT_WRITE_CHUNK)) < 0) {
+            fprintf(stderr, "Failed to write stream: %s\n",
+                    virGetLastErrorMessage());
+            goto cleanup;
+        }
+
+        if (got != THROUGHPUT_WRITE_CHUNK) {
+            fprintf(stderr, "Short write %d to stream\n", got);
+            goto cleanup;
+        }
+
+        total += got;
+    }
+
+    if (st->driver->streamFinish(st) != 0) {
+        fprintf(stderr, "Failed to finish stream: %s\n",
+                virGetLastErrorMessage());
+        goto cleanup;
+    }
+
+    VIR_TEST_DEBUG("Wrote %d MiB in %lld ms",
+                   THROUGHPUT_LEN / (1024 * 1024),
+                   (long long)(g_get_monotonic_time() - start) / 1000);
+
+    virStreamFree(st);
+    if (!(st = virStreamNew(conn, VIR_STREAM_NONBLOCK)))
+        goto cleanup;
+
+    if (virFDStreamOpenFile(st, file, 0, 0, O_RDONLY) < 0)
+        goto cleanup;
+
+    start = g_get_monotonic_time();
+    total = 0;
+    while (1) {
+        int got;
+        size_t i;
+
+        if ((got = st->driver->streamRecv(st, buf, THROUGHPUT_READ_CHUNK)) < 0) {
+            fprintf(stderr, "Failed to read stream: %s\n",
+                    virGetLastErrorMessage());
+            goto cleanup;
+        }
+
+        if (got == 0)
+            break;
+
+        for (i = 0; i < (size_t) got; i++) {
+            char want = ((total + i) / THROUGHPUT_WRITE_CHUNK) & 0xff;
+
+            if (buf[i] != want) {
+                fprintf(stderr, "Mismatched data at offset %zu\n", total + i);
+                goto cleanup;
+            }
+        }
+
+        total += got;
+    }
+
+    if (total != THROUGHPUT_LEN) {
+        fprintf(stderr, "Read %zu bytes, expected %d\n", total, THROUGHPUT_LEN);
+        goto cleanup;
+    }
+
+    if (st->driver->streamFinish(st) != 0) {
+        fprintf(stderr, "Failed to finish stream: %s\n",
+                virGetLastErrorMessage());
+        goto cleanup;
+    }
+
+    VIR_TEST_DEBUG("Read %d MiB in %lld ms",
+                   THROUGHPUT_LEN / (1024 * 1024),
+                   (long long)(g_get_monotonic_time() - start) / 1000);
+
+    ret = 0;
+ cleanup:
+    if (st)
+        virStreamFree(st);
+    if (file != NULL)
+        unlink(file);
+    if (conn)
+        virConnectClose(conn);
+    return ret;
+}
+
+
+static void
+testFDStreamCloseFD(void *opaque)
+{
+    int *fd = opaque;
+
+    /* give the writer time to fill the queue */
+    g_usleep(200 * 1000);
+    VIR_FORCE_CLOSE(*fd);
+}
+
+
+/* Writes to a FIFO through the I/O thread until the queue between the
+ * stream and the thread is full, then makes the thread fail by closing
+ * the reading end. The writer waiting for room in the queue must be woken
+ * up and get the error. */
+static int testFDStreamWriteError(const void *data)
+{
+    const char *scratchdir = data;
+    g_autofree char *fifo = NULL;
+    g_autofree char *buf = NULL;
+    virStreamPtr st = NULL;
+    virConnectPtr conn = NULL;
+    virThread closer;
+    bool closerStarted = false;
+    size_t total;
+    int readfd = -1;
+    int ret = -1;
+
+    if (!(conn = virConnectOpen("test:///default")))
+        goto cleanup;
+
+    fifo = g_strdup_printf("%s/write-error.fifo", scratchdir);
+    if (mkfifo(fifo, 0600) < 0) {
+        fprintf(stderr, "Cannot create FIFO '%s'\n", fifo);
+        goto cleanup;
+    }
+
+    /* opening the reading end first keeps the stream from blocking */
+    if ((readfd = open(fifo, O_RDONLY | O_NONBLOCK)) < 0) {
+        fprintf(stderr, "Cannot open FIFO '%s'\n", fifo);
+        goto cleanup;
+    }
+
+    if (!(st = virStreamNew(conn, VIR_STREAM_NONBLOCK)))
+        goto cleanup;
+
+    /* unlike regular files, FIFOs use the I/O thread only on request */
+    if (virFDStreamOpenBlockDevice(st, fifo, 0, 0, false, O_WRONLY) < 0)
+        goto cleanup;
+
+    if (virThreadCreate(&closer, true, testFDStreamCloseFD, &readfd) < 0)
+        goto cleanup;
+    closerStarted = true;
+
+    buf = g_new0(char, THROUGHPUT_WRITE_CHUNK);
+
+    for (total = 0; total < THROUGHPUT_LEN; total += THROUGHPUT_WRITE_CHUNK) {
+        if (st->driver->streamSend(st, buf, THROUGHPUT_WRITE_CHUNK) < 0)
+            break;
+    }
+
+    if (total >= THROUGHPUT_LEN) {
+        fprintf(stderr, "Writing to a closed FIFO didn't fail\n");
+        goto cleanup;
+    }
+
+    VIR_TEST_DEBUG("Write failed after %zu bytes: %s",
+                   total, virGetLastErrorMessage());
+
+    ret = 0;
+ cleanup:
+    if (closerStarted)
+        virThreadJoin(&closer);
+    VIR_FORCE_CLOSE(readfd);
+    if (st) {
+        st->driver->streamAbort(st);
+        virStreamFree(st);
+    }
+    if (fifo)
+        unlink(fifo);
+    if (conn)
+        virConnectClose(conn);
+    return ret;
+}
+
+
 #define SCRATCHDIRTEMPLATE abs_builddir "/fdstreamdir-XXXXXX"
 
 static int
@@ -305,6 +517,8 @@ mymain(void)
     char scratchdir[] = SCRATCHDIRTEMPLATE;
     int ret = 0;
 
+    signal(SIGPIPE, SIG_IGN);
+
     if (!g_mkdtemp(scratchdir)) {
         fprintf(stderr, "Cannot create fdstreamdir");
         abort();
@@ -318,6 +532,10 @@ mymain(void)
         ret = -1;
     if (virTestRun("Stream write non-blocking ", testFDStreamWriteNonblock, scratchdir) < 0)
         ret = -1;
+    if (virTestRun("Stream throughput ", testFDStreamThroughput, scratchdir) < 0)
+        ret = -1;
+    if (virTestRun("Stream write error ", testFDStreamWriteError, scratchdir) < 0)
+        ret = -1;
 
     if (getenv("LIBVIRT_SKIP_CLEANUP") == NULL)
         virFileDeleteTree(scratchdir);
@@ -541,6 +541,35 @@ static int testCgroupNewForSelfUnified(const void *args G_GNUC_UNUSED)
 }
 
 
+static int testCgroupSetupCpuPeriodQuota(const void *args G_GNUC_UNUSED)
+{
+    g_autoptr(virCgroup) cgroup = NULL;
+    unsigned long long period = 0;
+    long long quota = 0;
+
+    if (virCgroupNewSelf(&cgroup) < 0) {
+        fprintf(stderr, "Cannot create cgroup for self\n");
+        return -1;
+    }
+
+    if (virCgroupSetupCpuPeriodQuota(cgroup, 50000, 25000) < 0)
+        return -1;
+
+    if (virCgroupGetCpuCfsPeriod(cgroup, &period) < 0 ||
+        virCgroupGetCpuCfsQuota(cgroup, &quota) < 0)
+        return -1;
+
+    if (period != 50000 || quota != 25000) {
+        fprintf(stderr,
+                "Wrong CPU bandwidth: period=%llu quota=%lld\n",
+                period, quota);
+        return -1;
+    }
+
+    return 0;
+}
+
+
 static int testCgroupNewForSelfHybrid(const void *args G_GNUC_UNUSED)
 {
     g_autoptr(virCgroup) cgroup = NULL;
@@ -1083,6 +1112,9 @@ mymain(void)
         ret = -1;
     if (virTestRun("Cgroup available (unified)", testCgroupAvailable, (void*)0x1) < 0)
         ret = -1;
+    if (virTestRun("virCgroupSetupCpuPeriodQuota works (unified)",
+                   testCgroupSetupCpuPeriodQuota, NULL) < 0)
+        ret = -1;
     cleanupFakeFS(fakerootdir);
 
     /* cgroup hybrid */
@@ -3,6 +3,7 @@
 #include "testutils.h"
 #include "virfilewrapper.h"
 #include "virprocess.h"
+#include "virutil.h"
 
 
 struct testData {
@@ -60,6 +61,48 @@ test_virProcessGetStat(const void *opaque)
 }
 
 
+#ifdef __linux__
+static int
+test_virProcessGetStatInfo(const void *opaque G_GNUC_UNUSED)
+{
+    g_autofree char *data_dir = NULL;
+    const unsigned long long jiff2nsec = 1000ull * 1000ull * 1000ull /
+                                         (unsigned long long) sysconf(_SC_CLK_TCK);
+    unsigned long long userTime = 0;
+    unsigned long long sysTime = 0;
+    long rss = 0;
+    int cpu = 0;
+
+    data_dir = g_strdup_printf("%s/virprocessstatdata/complex/", abs_srcdir);
+    virFileWrapperAddPrefix("/proc/-1/task/-1/", data_dir);
+
+    virProcessGetStatInfo(NULL, &userTime, &sysTime, &cpu, &rss, -1, -1);
+
+    virFileWrapperClearPrefixes();
+
+    /* Every field in the data file holds its own (1-based) position */
+    if (userTime != (VIR_PROCESS_STAT_UTIME + 1) * jiff2nsec ||
+        sysTime != (VIR_PROCESS_STAT_STIME + 1) * jiff2nsec) {
+        fprintf(stderr, "Times incorrect, got user=%llu sys=%llu\n",
+                userTime, sysTime);
+        return -1;
+    }
+
+    if (rss != (VIR_PROCESS_STAT_RSS + 1) * virGetSystemPageSizeKB()) {
+        fprintf(stderr, "RSS incorrect, got %ld\n", rss);
+        return -1;
+    }
+
+    if (cpu != VIR_PROCESS_STAT_PROCESSOR + 1) {
+        fprintf(stderr, "CPU incorrect, got %d\n", cpu);
+        return -1;
+    }
+
+    return 0;
+}
+#endif /* __linux__ */
+
+
 static int
 mymain(void)
 {
@@ -82,6 +125,12 @@ mymain(void)
     DO_TEST("simple", "command", 5, true);
     DO_TEST("complex", "this) is ( a \t weird )\n)( (command ( ", 100, false);
 
+#ifdef __linux__
+    if (virTestRun("Reading process stat info",
+                   test_virProcessGetStatInfo, NULL) < 0)
+        ret = -1;
+#endif
+
     return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
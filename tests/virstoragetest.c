@@ -20,7 +20,10 @@
 
 #include <unistd.h>
 
+#include "storage_file_probe.h"
 #include "storage_source.h"
+#define LIBVIRT_STORAGE_SOURCE_PRIV_H_ALLOW
+#include "storage_source_priv.h"
 #include "testutils.h"
 #include "vircommand.h"
 #include "virfile.h"
@@ -406,6 +409,302 @@ testBackingParse(const void *args)
     return 0;
 }
 
+#define TEST_QCOW2_CAPACITY (1024ULL * 1024 * 1024)
+#define TEST_QCOW2_BACKING "base.img"
+
+static void
+testWriteBufInt32BE(char *buf, uint32_t val)
+{
+    buf[0] = (val >> 24) & 0xff;
+    buf[1] = (val >> 16) & 0xff;
+    buf[2] = (val >> 8) & 0xff;
+    buf[3] = val & 0xff;
+}
+
+
+static void
+testWriteBufInt64BE(char *buf, uint64_t val)
+{
+    testWriteBufInt32BE(buf, val >> 32);
+    testWriteBufInt32BE(buf + 4, val & 0xffffffff);
+}
+
+
+/*
+ * Build a minimal qcow2 v3 header with a backing format
+ * extension followed by the backing file name:
+ *
+ * [0..104)   header
+ * [104..120) backing format extension ("raw", padded to 8)
+ * [120..128) end of extensions
+ * [128..)    backing file name
+ */
+static char *
+testQcow2HeaderNew(size_t *len)
+{
+    const char *backing = TEST_QCOW2_BACKING;
+    size_t backingLen = strlen(backing);
+    char *buf;
+
+    *len = 128 + backingLen;
+    buf = g_new0(char, *len);
+
+    memcpy(buf, "QFI\xfb", 4);
+    testWriteBufInt32BE(buf + 4, 3); /* version */
+    testWriteBufInt64BE(buf + 8, 128); /* backing_file_offset */
+    testWriteBufInt32BE(buf + 16, backingLen); /* backing_file_size */
+    testWriteBufInt32BE(buf + 20, 16); /* cluster_bits */
+    testWriteBufInt64BE(buf + 24, TEST_QCOW2_CAPACITY); /* size */
+    testWriteBufInt64BE(buf + 80, 1); /* compatible_features: lazy refcounts */
+    testWriteBufInt32BE(buf + 96, 4); /* refcount_order */
+    testWriteBufInt32BE(buf + 100, 104); /* header_length */
+
+    testWriteBufInt32BE(buf + 104, 0xE2792ACA);
+    testWriteBufInt32BE(buf + 108, 3);
+    memcpy(buf + 112, "raw", 3);
+
+    memcpy(buf + 128, backing, backingLen);
+
+    return buf;
+}
+
+
+static virStorageSource *
+testProbeHeaderBuf(const char *buf,
+                   size_t len,
+                   int *rc)
+{
+    virStorageSource *src = virStorageSourceNew();
+    /* exact sized copy so that any read past the end is caught by valgrind */
+    g_autofree char *copy = g_new0(char, MAX(len, 1));
+
+    memcpy(copy, buf, len);
+
+    src->path = g_strdup("header.qcow2");
+    src->format = VIR_STORAGE_FILE_AUTO;
+
+    *rc = virStorageFileProbeGetMetadata(src, copy, len);
+    virResetLastError();
+
+    return src;
+}
+
+
+static int
+testProbeHeader(const void *args G_GNUC_UNUSED)
+{
+    g_autofree char *buf = NULL;
+    g_autoptr(virStorageSource) src = NULL;
+    size_t len;
+    size_t i;
+    int rc;
+    struct {
+        size_t offset;
+        uint64_t value;
+        bool wide;
+    } corruptions[] = {
+        { 8, 0, true }, /* no backing file */
+        { 8, 127, true }, /* backing file name overlaps extensions */
+        { 8, UINT64_MAX, true }, /* backing file past the buffer */
+        { 8, UINT64_MAX - 4, true }, /* offset + size overflow */
+        { 16, 1024, false }, /* backing file name too long */
+        { 16, UINT32_MAX, false },
+        { 100, 0, false }, /* extensions start inside the header */
+        { 100, 125, false }, /* extension header crosses the backing name */
+        { 100, UINT32_MAX, false }, /* extensions past the buffer */
+        { 108, 0, false }, /* empty backing format */
+        { 108, 17, false }, /* extension runs into the backing name */
+        { 108, UINT32_MAX, false }, /* extension past the buffer */
+        { 108, UINT32_MAX - 7, false }, /* extension padding overflow */
+        { 120, 0xdeadbeef, false }, /* missing end of extensions */
+        { 124, UINT32_MAX, false },
+    };
+
+    buf = testQcow2HeaderNew(&len);
+    src = testProbeHeaderBuf(buf, len, &rc);
+
+    if (rc < 0 ||
+        src->format != VIR_STORAGE_FILE_QCOW2 ||
+        src->capacity != TEST_QCOW2_CAPACITY ||
+        src->clusterSize != 65536 ||
+        STRNEQ_NULLABLE(src->backingStoreRaw, TEST_QCOW2_BACKING) ||
+        src->backingStoreRawFormat != VIR_STORAGE_FILE_RAW ||
+        !src->features ||
+        !virBitmapIsBitSet(src->features, VIR_STORAGE_FILE_FEATURE_LAZY_REFCOUNTS)) {
+        fprintf(stderr, "unexpected metadata: rc=%d format=%d capacity=%llu "
+                "clusterSize=%llu backing='%s' backingFormat=%d\n",
+                rc, src->format, src->capacity, src->clusterSize,
+                NULLSTR(src->backingStoreRaw), src->backingStoreRawFormat);
+        return -1;
+    }
+
+    /* every truncation of the header */
+    for (i = 0; i < len; i++) {
+        g_autoptr(virStorageSource) trunc = testProbeHeaderBuf(buf, i, &rc);
+
+        if (i < 4 && trunc->format != VIR_STORAGE_FILE_RAW) {
+            fprintf(stderr, "%zu byte header probed as format %d\n",
+                    i, trunc->format);
+            return -1;
+        }
+
+        if (trunc->backingStoreRaw) {
+            fprintf(stderr, "%zu byte header reported backing store '%s'\n",
+                    i, trunc->backingStoreRaw);
+            return -1;
+        }
+    }
+
+    /* corrupted offsets and lengths */
+    for (i = 0; i < G_N_ELEMENTS(corruptions); i++) {
+        g_autofree char *corrupt = g_memdup(buf, len);
+        g_autoptr(virStorageSource) bad = NULL;
+
+        if (corruptions[i].wide)
+            testWriteBufInt64BE(corrupt + corruptions[i].offset,
+                                corruptions[i].value);
+        else
+            testWriteBufInt32BE(corrupt + corruptions[i].offset,
+                                corruptions[i].value);
+
+        bad = testProbeHeaderBuf(corrupt, len, &rc);
+
+        /* anything reported must come from within the header */
+        if (bad->backingStoreRaw &&
+            strlen(bad->backingStoreRaw) > strlen(TEST_QCOW2_BACKING)) {
+            fprintf(stderr, "corruption %zu reported backing store '%s'\n",
+                    i, bad->backingStoreRaw);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+/*
+ * Looks up @key in the header cache and checks the result: @header is the
+ * expected cached header or NULL if a miss is expected.
+ */
+static int
+testHeaderCacheCheck(const char *key,
+                     const struct stat *st,
+                     const char *header)
+{
+    g_autofree char *buf = NULL;
+    ssize_t len = virStorageSourceHeaderCacheLookup(key, st, &buf);
+
+    if (!header) {
+        if (len >= 0) {
+            fprintf(stderr, "unexpected header cache hit for '%s'\n", key);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (len != (ssize_t) strlen(header) || memcmp(buf, header, len) != 0) {
+        fprintf(stderr, "header cache lookup of '%s' returned %zd\n", key, len);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+static int
+testHeaderCache(const void *args G_GNUC_UNUSED)
+{
+    g_autoptr(virStorageSource) src = virStorageSourceNew();
+    g_autofree char *key = NULL;
+    g_autofree char *otherKey = NULL;
+    struct stat st;
+    struct stat orig;
+    size_t i;
+    int ret = -1;
+
+    virStorageSourceHeaderCacheClear();
+
+    /* the same image read as different users must not share entries */
+    src->type = VIR_STORAGE_TYPE_FILE;
+    src->path = g_strdup(abs_srcdir "/virstoragetestdata/images/raw");
+
+    if (virStorageSourceInit(src) < 0)
+        return -1;
+
+    key = virStorageSourceHeaderCacheKey(src, 0, 0, &st);
+    otherKey = virStorageSourceHeaderCacheKey(src, 107, 107, &st);
+    virStorageSourceDeinit(src);
+
+    if (!key || !otherKey || STREQ(key, otherKey)) {
+        fprintf(stderr, "unexpected header cache keys '%s' and '%s'\n",
+                NULLSTR(key), NULLSTR(otherKey));
+        return -1;
+    }
+
+    memset(&orig, 0, sizeof(orig));
+    orig.st_size = 1024;
+    orig.st_mtime = time(NULL) - 60;
+    orig.st_ctime = orig.st_mtime;
+
+    virStorageSourceHeaderCacheAdd(g_strdup(key), &orig, "header", 6);
+
+    if (testHeaderCacheCheck(key, &orig, "header") < 0 ||
+        testHeaderCacheCheck(otherKey, &orig, NULL) < 0)
+        goto cleanup;
+
+    /* changed images are not served from the cache */
+    st = orig;
+    st.st_size++;
+    if (testHeaderCacheCheck(key, &st, NULL) < 0)
+        goto cleanup;
+
+    st = orig;
+    st.st_mtime++;
+    if (testHeaderCacheCheck(key, &st, NULL) < 0)
+        goto cleanup;
+
+    st = orig;
+    st.st_ctime++;
+    if (testHeaderCacheCheck(key, &st, NULL) < 0)
+        goto cleanup;
+
+    /* re-adding an entry replaces it */
+    virStorageSourceHeaderCacheAdd(g_strdup(key), &st, "updated", 7);
+    if (testHeaderCacheCheck(key, &st, "updated") < 0 ||
+        testHeaderCacheCheck(key, &orig, NULL) < 0)
+        goto cleanup;
+
+    /* recently modified images are not cached at all */
+    st = orig;
+    st.st_mtime = time(NULL);
+    virStorageSourceHeaderCacheAdd(g_strdup("recent"), &st, "header", 6);
+    if (testHeaderCacheCheck("recent", &st, NULL) < 0)
+        goto cleanup;
+
+    /* the oldest entries are evicted once the cache is full */
+    virStorageSourceHeaderCacheClear();
+
+    for (i = 0; i <= VIR_STORAGE_SOURCE_HEADER_CACHE_SIZE; i++) {
+        virStorageSourceHeaderCacheAdd(g_strdup_printf("evict-%zu", i),
+                                       &orig, "header", 6);
+    }
+
+    if (testHeaderCacheCheck("evict-0", &orig, NULL) < 0 ||
+        testHeaderCacheCheck("evict-1", &orig, "header") < 0)
+        goto cleanup;
+
+    g_clear_pointer(&key, g_free);
+    key = g_strdup_printf("evict-%d", VIR_STORAGE_SOURCE_HEADER_CACHE_SIZE);
+    if (testHeaderCacheCheck(key, &orig, "header") < 0)
+        goto cleanup;
+
+    ret = 0;
+
+ cleanup:
+    virStorageSourceHeaderCacheClear();
+    return ret;
+}
+
 
 static int
 mymain(void)
@@ -424,6 +723,12 @@ mymain(void)
     if (storageRegisterAll() < 0)
        return EXIT_FAILURE;
 
+    if (virTestRun("qcow2 header probe", testProbeHeader, NULL) < 0)
+        ret = -1;
+
+    if (virTestRun("image header cache", testHeaderCache, NULL) < 0)
+        ret = -1;
+
 #define TEST_CHAIN(testname, start, format, flags) \
     do { \
         data = (struct testChainData){ testname, start, format, flags }; \
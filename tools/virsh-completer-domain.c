@@ -1024,6 +1024,18 @@ virshDomainMigrateCompMethodsCompleter(vshControl *ctl,
 }
 
 
+char **
+virshDomainMigrateEvacuateOrderCompleter(vshControl *ctl G_GNUC_UNUSED,
+                                         const vshCmd *cmd G_GNUC_UNUSED,
+                                         unsigned int flags)
+{
+    virCheckFlags(0, NULL);
+
+    return virshEnumComplete(VIRSH_MIGRATE_EVACUATE_ORDER_LAST,
+                             virshMigrateEvacuateOrderTypeToString);
+}
+
+
 char **
 virshDomainStorageFileFormatCompleter(vshControl *ctl G_GNUC_UNUSED,
                                       const vshCmd *cmd G_GNUC_UNUSED,
@@ -156,6 +156,11 @@ virshDomainMigrateCompMethodsCompleter(vshControl *ctl,
                                        const vshCmd *cmd,
                                        unsigned int flags);
 
+char **
+virshDomainMigrateEvacuateOrderCompleter(vshControl *ctl,
+                                         const vshCmd *cmd,
+                                         unsigned int flags);
+
 
 char **
 virshDomainStorageFileFormatCompleter(vshControl *ctl,
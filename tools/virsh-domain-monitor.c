@@ -2066,6 +2066,10 @@ static const vshCmdOptDef opts_domstats[] = {
      .type = VSH_OT_BOOL,
      .help = N_("report hypervisor-specific statistics"),
     },
+    {.name = "startup",
+     .type = VSH_OT_BOOL,
+     .help = N_("report timing of domain startup phases"),
+    },
     {.name = "list-active",
      .type = VSH_OT_BOOL,
      .help = N_("list only active domains"),
@@ -2190,6 +2194,9 @@ cmdDomstats(vshControl *ctl, const vshCmd *cmd)
     if (vshCommandOptBool(cmd, "vm"))
         stats |= VIR_DOMAIN_STATS_VM;
 
+    if (vshCommandOptBool(cmd, "startup"))
+        stats |= VIR_DOMAIN_STATS_STARTUP;
+
     if (vshCommandOptBool(cmd, "list-active"))
         flags |= VIR_CONNECT_GET_ALL_DOMAINS_STATS_ACTIVE;
 
@@ -4196,6 +4196,14 @@ static const vshCmdOptDef opts_save[] = {
      .type = VSH_OT_BOOL,
      .help = N_("display the progress of save")
     },
+    {.name = "parallel",
+     .type = VSH_OT_BOOL,
+     .help = N_("save using multiple parallel streams")
+    },
+    {.name = "parallel-channels",
+     .type = VSH_OT_INT,
+     .help = N_("number of extra channels for parallel save")
+    },
     {.name = NULL}
 };
 
@@ -4211,6 +4219,10 @@ doSave(void *opaque)
     unsigned int flags = 0;
     const char *xmlfile = NULL;
     g_autofree char *xml = NULL;
+    virTypedParameterPtr params = NULL;
+    int nparams = 0;
+    int maxparams = 0;
+    int channels = 0;
     int rc;
 #ifndef WIN32
     sigset_t sigmask, oldsigmask;
@@ -4224,12 +4236,24 @@ doSave(void *opaque)
     if (vshCommandOptStringReq(ctl, cmd, "file", &to) < 0)
         goto out;
 
+    if ((rc = vshCommandOptInt(ctl, cmd, "parallel-channels", &channels)) < 0)
+        goto out;
+    if (rc > 0 &&
+        virTypedParamsAddInt(&params, &nparams, &maxparams,
+                             VIR_DOMAIN_SAVE_PARAM_PARALLEL_CHANNELS,
+                             channels) < 0) {
+        vshSaveLibvirtError();
+        goto out;
+    }
+
     if (vshCommandOptBool(cmd, "bypass-cache"))
         flags |= VIR_DOMAIN_SAVE_BYPASS_CACHE;
     if (vshCommandOptBool(cmd, "running"))
         flags |= VIR_DOMAIN_SAVE_RUNNING;
     if (vshCommandOptBool(cmd, "paused"))
         flags |= VIR_DOMAIN_SAVE_PAUSED;
+    if (vshCommandOptBool(cmd, "parallel"))
+        flags |= VIR_DOMAIN_SAVE_PARALLEL;
 
     if (vshCommandOptStringReq(ctl, cmd, "xml", &xmlfile) < 0)
         goto out;
@@ -4243,7 +4267,18 @@ doSave(void *opaque)
         goto out;
     }
 
-    if (flags || xml) {
+    if (flags & VIR_DOMAIN_SAVE_PARALLEL) {
+        if (virTypedParamsAddString(&params, &nparams, &maxparams,
+                                    VIR_DOMAIN_SAVE_PARAM_FILE, to) < 0 ||
+            (xml &&
+             virTypedParamsAddString(&params, &nparams, &maxparams,
+                                     VIR_DOMAIN_SAVE_PARAM_DXML, xml) < 0)) {
+            vshSaveLibvirtError();
+            goto out;
+        }
+
+        rc = virDomainSaveParams(dom, params, nparams, flags);
+    } else if (flags || xml) {
         rc = virDomainSaveFlags(dom, to, xml, flags);
     } else {
         rc = virDomainSave(dom, to);
@@ -4257,6 +4292,7 @@ doSave(void *opaque)
     data->ret = 0;
 
  out:
+    virTypedParamsFree(params, nparams);
 #ifndef WIN32
     pthread_sigmask(SIG_SETMASK, &oldsigmask, NULL);
  out_sig:
@@ -4484,6 +4520,8 @@ cmdSave(vshControl *ctl, const vshCmd *cmd)
         .ret = -1,
     };
 
+    VSH_REQUIRE_OPTION("parallel-channels", "parallel");
+
     if (!(dom = virshCommandOptDomain(ctl, cmd, &name)))
         return false;
 
@@ -6201,6 +6239,16 @@ cmdDomjobinfo(vshControl *ctl, const vshCmd *cmd)
     int rc;
     size_t i;
     bool rawstats = vshCommandOptBool(cmd, "rawstats");
+    const struct {
+        const char *field;
+        const char *label;
+    } phaseTimes[] = {
+        { VIR_DOMAIN_JOB_TIME_PHASE_BEGIN, N_("Begin phase:") },
+        { VIR_DOMAIN_JOB_TIME_PHASE_PREPARE, N_("Prepare phase:") },
+        { VIR_DOMAIN_JOB_TIME_PHASE_PERFORM, N_("Perform phase:") },
+        { VIR_DOMAIN_JOB_TIME_PHASE_FINISH, N_("Finish phase:") },
+        { VIR_DOMAIN_JOB_TIME_PHASE_CONFIRM, N_("Confirm phase:") },
+    };
 
     VSH_REQUIRE_OPTION("keep-completed", "completed");
 
@@ -6360,6 +6408,15 @@ cmdDomjobinfo(vshControl *ctl, const vshCmd *cmd)
             vshPrint(ctl, "%-17s %-.3lf %s/s\n",
                      _("File bandwidth:"), val, unit);
         }
+
+        if ((rc = virTypedParamsGetULLong(params, nparams,
+                                          VIR_DOMAIN_JOB_DISK_TIME_REMAINING,
+                                          &value)) < 0) {
+            goto save_error;
+        } else if (rc && value) {
+            vshPrint(ctl, "%-17s %-12llu ms\n",
+                     _("File time left:"), value);
+        }
     }
 
     if ((rc = virTypedParamsGetULLong(params, nparams,
@@ -6413,6 +6470,15 @@ cmdDomjobinfo(vshControl *ctl, const vshCmd *cmd)
     else if (rc)
         vshPrint(ctl, "%-17s %-12llu ms\n", _("Setup time:"), value);
 
+    for (i = 0; i < G_N_ELEMENTS(phaseTimes); i++) {
+        if ((rc = virTypedParamsGetULLong(params, nparams,
+                                          phaseTimes[i].field,
+                                          &value)) < 0)
+            goto save_error;
+        else if (rc)
+            vshPrint(ctl, "%-17s %-12llu ms\n", _(phaseTimes[i].label), value);
+    }
+
     if ((rc = virTypedParamsGetULLong(params, nparams,
                                       VIR_DOMAIN_JOB_COMPRESSION_CACHE,
                                       &value)) < 0) {
@@ -10982,10 +11048,18 @@ static const vshCmdOptDef opts_migrate[] = {
      .type = VSH_OT_BOOL,
      .help = N_("resume failed post-copy migration")
     },
+    {.name = "postcopy-preempt",
+     .type = VSH_OT_BOOL,
+     .help = N_("use a dedicated connection for pages requested during post-copy migration")
+    },
     {.name = "zerocopy",
      .type = VSH_OT_BOOL,
      .help = N_("use zero-copy mechanism for migrating memory pages")
     },
+    {.name = "auto-tune",
+     .type = VSH_OT_BOOL,
+     .help = N_("automatically tune migration of guests dirtying memory quickly")
+    },
     {.name = "migrateuri",
      .type = VSH_OT_STRING,
      .completer = virshCompleteEmpty,
@@ -11382,9 +11456,15 @@ doMigrate(void *opaque)
     if (vshCommandOptBool(cmd, "postcopy-resume"))
         flags |= VIR_MIGRATE_POSTCOPY_RESUME;
 
+    if (vshCommandOptBool(cmd, "postcopy-preempt"))
+        flags |= VIR_MIGRATE_POSTCOPY_PREEMPT;
+
     if (vshCommandOptBool(cmd, "zerocopy"))
         flags |= VIR_MIGRATE_ZEROCOPY;
 
+    if (vshCommandOptBool(cmd, "auto-tune"))
+        flags |= VIR_MIGRATE_AUTO_TUNE;
+
     if (vshCommandOptBool(cmd, "tls"))
         flags |= VIR_MIGRATE_TLS;
 
@@ -11490,6 +11570,7 @@ cmdMigrate(vshControl *ctl, const vshCmd *cmd)
     VSH_EXCLUSIVE_OPTIONS("timeout-suspend", "timeout-postcopy");
     VSH_REQUIRE_OPTION("postcopy-after-precopy", "postcopy");
     VSH_REQUIRE_OPTION("postcopy-resume", "postcopy");
+    VSH_REQUIRE_OPTION("postcopy-preempt", "postcopy");
     VSH_REQUIRE_OPTION("timeout-postcopy", "postcopy");
     VSH_REQUIRE_OPTION("persistent-xml", "persistent");
     VSH_REQUIRE_OPTION("tls-destination", "tls");
@@ -11570,6 +11651,581 @@ cmdMigrate(vshControl *ctl, const vshCmd *cmd)
     return !data.ret;
 }
 
+/*
+ * "migrate-evacuate" command
+ */
+static const vshCmdInfo info_migrate_evacuate[] = {
+    {.name = "help",
+     .data = N_("migrate multiple domains to another host")
+    },
+    {.name = "desc",
+     .data = N_("Migrate several (by default all running) domains to another "
+                "host, running at most the given number of migrations at the "
+                "same time.")
+    },
+    {.name = NULL}
+};
+
+static const vshCmdOptDef opts_migrate_evacuate[] = {
+    {.name = "desturi",
+     .type = VSH_OT_DATA,
+     .flags = VSH_OFLAG_REQ,
+     .completer = virshCompleteEmpty,
+     .help = N_("connection URI of the destination host as seen from the client(normal migration) or source(p2p migration)")
+    },
+    VIRSH_COMMON_OPT_LIVE(N_("live migration")),
+    {.name = "p2p",
+     .type = VSH_OT_BOOL,
+     .help = N_("peer-2-peer migration")
+    },
+    {.name = "direct",
+     .type = VSH_OT_BOOL,
+     .help = N_("direct migration")
+    },
+    {.name = "tunnelled",
+     .type = VSH_OT_BOOL,
+     .help = N_("tunnelled migration")
+    },
+    {.name = "persistent",
+     .type = VSH_OT_BOOL,
+     .help = N_("persist VM on destination")
+    },
+    {.name = "undefinesource",
+     .type = VSH_OT_BOOL,
+     .help = N_("undefine VM on source")
+    },
+    {.name = "copy-storage-all",
+     .type = VSH_OT_BOOL,
+     .help = N_("migration with non-shared storage with full disk copy")
+    },
+    {.name = "auto-converge",
+     .type = VSH_OT_BOOL,
+     .help = N_("force convergence during live migration")
+    },
+    {.name = "auto-tune",
+     .type = VSH_OT_BOOL,
+     .help = N_("automatically tune migration of guests dirtying memory quickly")
+    },
+    {.name = "tls",
+     .type = VSH_OT_BOOL,
+     .help = N_("use TLS for migration")
+    },
+    {.name = "verbose",
+     .type = VSH_OT_BOOL,
+     .help = N_("display the aggregate progress of the migrations")
+    },
+    {.name = "parallel-migrations",
+     .type = VSH_OT_INT,
+     .help = N_("maximum number of migrations running at the same time (default 2)")
+    },
+    {.name = "bandwidth",
+     .type = VSH_OT_INT,
+     .help = N_("total bandwidth limit in MiB/s shared by all running migrations")
+    },
+    {.name = "order",
+     .type = VSH_OT_STRING,
+     .completer = virshDomainMigrateEvacuateOrderCompleter,
+     .help = N_("order in which domains are migrated: none, memory, dirty-rate")
+    },
+    VIRSH_COMMON_OPT_DOMAIN_OT_ARGV(N_("list of domains to migrate"),
+                                    VIR_CONNECT_LIST_DOMAINS_ACTIVE),
+    {.name = NULL}
+};
+
+VIR_ENUM_IMPL(virshMigrateEvacuateOrder,
+              VIRSH_MIGRATE_EVACUATE_ORDER_LAST,
+              "none",
+              "memory",
+              "dirty-rate");
+
+typedef struct _virshEvacuateData virshEvacuateData;
+typedef struct _virshEvacuateDomain virshEvacuateDomain;
+
+struct _virshEvacuateData {
+    const char *desturi;
+    virConnectPtr dconn; /* NULL for p2p and direct migration */
+    unsigned int flags;
+};
+
+struct _virshEvacuateDomain {
+    virshEvacuateData *data;
+    virDomainPtr dom;
+    unsigned long long key; /* sort key according to --order */
+
+    virTypedParameterPtr params;
+    int nparams;
+    int maxparams;
+    unsigned long long bandwidth;
+
+    virThread thread;
+    bool started;
+    bool done;
+    int finished; /* set by the worker thread, accessed atomically */
+    int ret;
+    virErrorPtr err;
+
+    unsigned long long dataTotal;
+    unsigned long long dataProcessed;
+};
+
+
+static void
+virshEvacuateDomainWorker(void *opaque)
+{
+    virshEvacuateDomain *item = opaque;
+    virshEvacuateData *data = item->data;
+#ifndef WIN32
+    sigset_t sigmask, oldsigmask;
+
+    /* SIGINT is handled by the thread scheduling the migrations */
+    sigemptyset(&sigmask);
+    sigaddset(&sigmask, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &sigmask, &oldsigmask);
+#endif /* !WIN32 */
+
+    if (data->dconn) {
+        g_autoptr(virshDomain) ddom = NULL;
+
+        if ((ddom = virDomainMigrate3(item->dom, data->dconn,
+                                      item->params, item->nparams,
+                                      data->flags)))
+            item->ret = 0;
+    } else {
+        if (virDomainMigrateToURI3(item->dom, data->desturi,
+                                   item->params, item->nparams,
+                                   data->flags) == 0)
+            item->ret = 0;
+    }
+
+    if (item->ret < 0)
+        item->err = virSaveLastError();
+
+#ifndef WIN32
+    pthread_sigmask(SIG_SETMASK, &oldsigmask, NULL);
+#endif /* !WIN32 */
+    g_atomic_int_set(&item->finished, 1);
+}
+
+
+static int
+virshEvacuateDomainSorter(const void *a,
+                          const void *b)
+{
+    const virshEvacuateDomain *da = a;
+    const virshEvacuateDomain *db = b;
+
+    if (da->key < db->key)
+        return -1;
+    if (da->key > db->key)
+        return 1;
+    return 0;
+}
+
+
+/* Computes the sort keys of all domains. Domains using less memory or
+ * dirtying it slower are migrated first as they are quick to move and free
+ * the host resources for the rest of the evacuation. */
+static int
+virshEvacuateDomainsSort(vshControl *ctl,
+                         virshEvacuateDomain *items,
+                         size_t nitems,
+                         virshMigrateEvacuateOrder order)
+{
+    size_t i;
+
+    switch (order) {
+    case VIRSH_MIGRATE_EVACUATE_ORDER_NONE:
+    case VIRSH_MIGRATE_EVACUATE_ORDER_LAST:
+        return 0;
+
+    case VIRSH_MIGRATE_EVACUATE_ORDER_MEMORY:
+        for (i = 0; i < nitems; i++) {
+            virDomainInfo info;
+
+            if (virDomainGetInfo(items[i].dom, &info) < 0)
+                return -1;
+            items[i].key = info.memory;
+        }
+        break;
+
+    case VIRSH_MIGRATE_EVACUATE_ORDER_DIRTY_RATE: {
+        g_autofree virDomainPtr *domlist = g_new0(virDomainPtr, nitems + 1);
+        virDomainStatsRecordPtr *records = NULL;
+        virDomainStatsRecordPtr *next;
+
+        for (i = 0; i < nitems; i++)
+            domlist[i] = items[i].dom;
+
+        if (virDomainListGetStats(domlist, VIR_DOMAIN_STATS_DIRTYRATE,
+                                  &records, 0) < 0)
+            return -1;
+
+        for (next = records; *next; next++) {
+            long long rate = 0;
+
+            /* the rate is only known after virDomainStartDirtyRateCalc */
+            if (virTypedParamsGetLLong((*next)->params, (*next)->nparams,
+                                       "dirtyrate.megabytes_per_second",
+                                       &rate) < 0) {
+                virDomainStatsRecordListFree(records);
+                return -1;
+            }
+
+            for (i = 0; i < nitems; i++) {
+                if (STREQ(virDomainGetName(items[i].dom),
+                          virDomainGetName((*next)->dom)))
+                    items[i].key = MAX(rate, 0);
+            }
+        }
+
+        virDomainStatsRecordListFree(records);
+        break;
+    }
+    }
+
+    for (i = 0; i < nitems; i++) {
+        vshDebug(ctl, VSH_ERR_DEBUG, "evacuate: domain '%s' key %llu\n",
+                 virDomainGetName(items[i].dom), items[i].key);
+    }
+
+    qsort(items, nitems, sizeof(*items), virshEvacuateDomainSorter);
+    return 0;
+}
+
+
+/* Splits the total @bandwidth evenly among @nrunning migrations. Already
+ * running migrations are updated, the rest will get the limit when they are
+ * started. */
+static void
+virshEvacuateBalanceBandwidth(vshControl *ctl,
+                              virshEvacuateDomain *items,
+                              size_t nitems,
+                              unsigned long long bandwidth,
+                              size_t nrunning)
+{
+    unsigned long long share;
+    size_t i;
+
+    if (bandwidth == 0 || nrunning == 0)
+        return;
+
+    share = MAX(bandwidth / nrunning, 1);
+
+    for (i = 0; i < nitems; i++) {
+        virshEvacuateDomain *item = items + i;
+
+        if (item->done || item->bandwidth == share)
+            continue;
+
+        item->bandwidth = share;
+        if (!item->started)
+            continue;
+
+        vshDebug(ctl, VSH_ERR_DEBUG,
+                 "evacuate: setting bandwidth of '%s' to %llu MiB/s\n",
+                 virDomainGetName(item->dom), share);
+
+        /* the migration may be just finishing, don't treat this as fatal */
+        if (virDomainMigrateSetMaxSpeed(item->dom, share, 0) < 0) {
+            vshDebug(ctl, VSH_ERR_INFO,
+                     "evacuate: failed to change bandwidth of '%s'\n",
+                     virDomainGetName(item->dom));
+            vshResetLibvirtError();
+        }
+    }
+}
+
+
+static void
+virshEvacuatePrintProgress(virshEvacuateDomain *items,
+                           size_t nitems)
+{
+    unsigned long long total = 0;
+    unsigned long long remaining = 0;
+    size_t ndone = 0;
+    size_t i;
+
+    for (i = 0; i < nitems; i++) {
+        virshEvacuateDomain *item = items + i;
+
+        if (item->done) {
+            ndone++;
+            continue;
+        }
+
+        if (item->started) {
+            virDomainJobInfo info;
+
+            if (virDomainGetJobInfo(item->dom, &info) == 0 &&
+                info.type == VIR_DOMAIN_JOB_UNBOUNDED) {
+                item->dataTotal = info.dataTotal;
+                item->dataProcessed = info.dataProcessed;
+            } else {
+                vshResetLibvirtError();
+            }
+        }
+
+        total += item->dataTotal;
+        remaining += item->dataTotal - MIN(item->dataProcessed,
+                                           item->dataTotal);
+    }
+
+    /* see comments in vshError about why we must flush */
+    fflush(stdout);
+    fprintf(stderr, "\r%s: [%zu/%zu domains, %3d %%]",
+            _("Evacuation"), ndone, nitems,
+            total ? (int)(100.0 - remaining * 100.0 / total) : 0);
+    fflush(stderr);
+}
+
+
+static bool
+cmdMigrateEvacuate(vshControl *ctl, const vshCmd *cmd)
+{
+    virshControl *priv = ctl->privData;
+    virshEvacuateData data = { 0 };
+    virshEvacuateDomain *items = NULL;
+    size_t nitems = 0;
+    unsigned int parallel = 2;
+    unsigned long long bandwidth = 0;
+    const char *orderstr = NULL;
+    int order = VIRSH_MIGRATE_EVACUATE_ORDER_NONE;
+    bool verbose = vshCommandOptBool(cmd, "verbose");
+    const vshCmdOpt *opt = NULL;
+    size_t nstarted = 0;
+    size_t nrunning = 0;
+    size_t nfailed = 0;
+    bool finished;
+    size_t i;
+    bool ret = false;
+#ifndef WIN32
+    struct sigaction sig_action;
+    struct sigaction old_sig_action;
+#endif /* !WIN32 */
+
+    VSH_EXCLUSIVE_OPTIONS("p2p", "direct");
+    VSH_REQUIRE_OPTION("tunnelled", "p2p");
+
+    if (vshCommandOptStringReq(ctl, cmd, "desturi", &data.desturi) < 0)
+        return false;
+
+    if (vshCommandOptUInt(ctl, cmd, "parallel-migrations", &parallel) < 0)
+        return false;
+    if (parallel == 0) {
+        vshError(ctl, "%s", _("number of parallel migrations must be positive"));
+        return false;
+    }
+
+    if (vshCommandOptULongLong(ctl, cmd, "bandwidth", &bandwidth) < 0)
+        return false;
+
+    if (vshCommandOptStringReq(ctl, cmd, "order", &orderstr) < 0)
+        return false;
+    if (orderstr &&
+        (order = virshMigrateEvacuateOrderTypeFromString(orderstr)) < 0) {
+        vshError(ctl, _("Invalid migration order '%s'"), orderstr);
+        return false;
+    }
+
+    if (vshCommandOptBool(cmd, "live"))
+        data.flags |= VIR_MIGRATE_LIVE;
+    if (vshCommandOptBool(cmd, "p2p"))
+        data.flags |= VIR_MIGRATE_PEER2PEER;
+    if (vshCommandOptBool(cmd, "tunnelled"))
+        data.flags |= VIR_MIGRATE_TUNNELLED;
+    if (vshCommandOptBool(cmd, "persistent"))
+        data.flags |= VIR_MIGRATE_PERSIST_DEST;
+    if (vshCommandOptBool(cmd, "undefinesource"))
+        data.flags |= VIR_MIGRATE_UNDEFINE_SOURCE;
+    if (vshCommandOptBool(cmd, "copy-storage-all"))
+        data.flags |= VIR_MIGRATE_NON_SHARED_DISK;
+    if (vshCommandOptBool(cmd, "auto-converge"))
+        data.flags |= VIR_MIGRATE_AUTO_CONVERGE;
+    if (vshCommandOptBool(cmd, "auto-tune"))
+        data.flags |= VIR_MIGRATE_AUTO_TUNE;
+    if (vshCommandOptBool(cmd, "tls"))
+        data.flags |= VIR_MIGRATE_TLS;
+
+    if (vshCommandOptBool(cmd, "domain")) {
+        while ((opt = vshCommandOptArgv(ctl, cmd, opt))) {
+            virDomainPtr dom;
+
+            if (!(dom = virshLookupDomainBy(ctl, opt->data,
+                                            VIRSH_BYID |
+                                            VIRSH_BYUUID | VIRSH_BYNAME)))
+                goto cleanup;
+
+            VIR_EXPAND_N(items, nitems, 1);
+            items[nitems - 1].dom = dom;
+        }
+    } else {
+        virDomainPtr *domains = NULL;
+        int ndomains;
+
+        if ((ndomains = virConnectListAllDomains(priv->conn, &domains,
+                                                 VIR_CONNECT_LIST_DOMAINS_ACTIVE)) < 0)
+            goto cleanup;
+
+        items = g_new0(virshEvacuateDomain, ndomains);
+        nitems = ndomains;
+        for (i = 0; i < nitems; i++)
+            items[i].dom = domains[i];
+        g_free(domains);
+    }
+
+    if (nitems == 0) {
+        vshPrintExtra(ctl, "%s\n", _("No domains to migrate"));
+        ret = true;
+        goto cleanup;
+    }
+
+    if (virshEvacuateDomainsSort(ctl, items, nitems,
+                                 (virshMigrateEvacuateOrder) order) < 0)
+        goto cleanup;
+
+    if (!(data.flags & VIR_MIGRATE_PEER2PEER) &&
+        !vshCommandOptBool(cmd, "direct")) {
+        /* For traditional live migration, connect to the destination host. */
+        if (!(data.dconn = virshConnect(ctl, data.desturi, false)))
+            goto cleanup;
+    }
+
+    for (i = 0; i < nitems; i++) {
+        items[i].data = &data;
+        items[i].ret = -1;
+    }
+
+#ifndef WIN32
+    intCaught = 0;
+    sig_action.sa_sigaction = virshCatchInt;
+    sig_action.sa_flags = SA_SIGINFO;
+    sigemptyset(&sig_action.sa_mask);
+    sigaction(SIGINT, &sig_action, &old_sig_action);
+#endif /* !WIN32 */
+
+    while (nstarted < nitems || nrunning > 0) {
+        if (intCaught) {
+            /* abort everything in flight and do not start anything new */
+            intCaught = 0;
+            for (i = 0; i < nitems; i++) {
+                if (items[i].started && !items[i].done &&
+                    virDomainAbortJob(items[i].dom) < 0)
+                    vshResetLibvirtError();
+            }
+            nfailed += nitems - nstarted;
+            nstarted = nitems;
+        }
+
+        if (nrunning < parallel && nstarted < nitems) {
+            size_t nstart = MIN(parallel - nrunning, nitems - nstarted);
+
+            virshEvacuateBalanceBandwidth(ctl, items, nitems, bandwidth,
+                                          nrunning + nstart);
+
+            for (i = nstarted; i < nstarted + nstart; i++) {
+                virshEvacuateDomain *item = items + i;
+
+                if (item->bandwidth &&
+                    virTypedParamsAddULLong(&item->params, &item->nparams,
+                                            &item->maxparams,
+                                            VIR_MIGRATE_PARAM_BANDWIDTH,
+                                            item->bandwidth) < 0) {
+                    vshSaveLibvirtError();
+                    break;
+                }
+
+                vshDebug(ctl, VSH_ERR_DEBUG, "evacuate: migrating '%s'\n",
+                         virDomainGetName(item->dom));
+
+                if (virThreadCreate(&item->thread, true,
+                                    virshEvacuateDomainWorker, item) < 0) {
+                    vshError(ctl, _("Failed to start migration of domain '%s'"),
+                             virDomainGetName(item->dom));
+                    break;
+                }
+                item->started = true;
+                nrunning++;
+            }
+
+            if (i < nstarted + nstart) {
+                /* starting a migration failed, let the others finish */
+                nfailed += nitems - i;
+                nstarted = nitems;
+            } else {
+                nstarted += nstart;
+            }
+        }
+
+        if (nrunning == 0)
+            break;
+
+        g_usleep(500 * 1000);
+
+        finished = false;
+        for (i = 0; i < nitems; i++) {
+            virshEvacuateDomain *item = items + i;
+
+            if (!item->started || item->done ||
+                !g_atomic_int_get(&item->finished))
+                continue;
+
+            virThreadJoin(&item->thread);
+            item->done = true;
+            finished = true;
+            nrunning--;
+
+            if (verbose)
+                fprintf(stderr, "\n");
+
+            if (item->ret == 0) {
+                vshPrintExtra(ctl, _("Domain '%s' migrated\n"),
+                              virDomainGetName(item->dom));
+            } else {
+                nfailed++;
+                vshError(ctl, _("Failed to migrate domain '%s': %s"),
+                         virDomainGetName(item->dom),
+                         item->err && item->err->message ?
+                         item->err->message : _("unknown error"));
+            }
+        }
+
+        /* with domains still waiting the bandwidth is rebalanced when they
+         * are started in the next round */
+        if (finished && nstarted == nitems)
+            virshEvacuateBalanceBandwidth(ctl, items, nitems, bandwidth,
+                                          nrunning);
+
+        if (verbose)
+            virshEvacuatePrintProgress(items, nitems);
+    }
+
+#ifndef WIN32
+    sigaction(SIGINT, &old_sig_action, NULL);
+#endif /* !WIN32 */
+
+    if (verbose)
+        fprintf(stderr, "\n");
+
+    if (nfailed > 0) {
+        vshError(ctl, _("Failed to migrate %zu of %zu domains"),
+                 nfailed, nitems);
+        goto cleanup;
+    }
+
+    ret = true;
+
+ cleanup:
+    for (i = 0; i < nitems; i++) {
+        virTypedParamsFree(items[i].params, items[i].nparams);
+        virFreeError(items[i].err);
+        virshDomainFree(items[i].dom);
+    }
+    g_free(items);
+    if (data.dconn)
+        virConnectClose(data.dconn);
+    return ret;
+}
+
 /*
  * "migrate-setmaxdowntime" command
  */
@@ -14201,6 +14857,12 @@ const vshCmdDef domManagementCmds[] = {
      .info = info_migrate,
      .flags = 0
     },
+    {.name = "migrate-evacuate",
+     .handler = cmdMigrateEvacuate,
+     .opts = opts_migrate_evacuate,
+     .info = info_migrate_evacuate,
+     .flags = 0
+    },
     {.name = "migrate-setmaxdowntime",
      .handler = cmdMigrateSetMaxDowntime,
      .opts = opts_migrate_setmaxdowntime,
@@ -55,6 +55,15 @@ typedef enum {
 
 VIR_ENUM_DECL(virshDomainDirtyRateCalcMode);
 
+typedef enum {
+    VIRSH_MIGRATE_EVACUATE_ORDER_NONE,
+    VIRSH_MIGRATE_EVACUATE_ORDER_MEMORY,
+    VIRSH_MIGRATE_EVACUATE_ORDER_DIRTY_RATE,
+    VIRSH_MIGRATE_EVACUATE_ORDER_LAST,
+} virshMigrateEvacuateOrder;
+
+VIR_ENUM_DECL(virshMigrateEvacuateOrder);
+
 extern const vshCmdDef domManagementCmds[];
 
 VIR_ENUM_DECL(virshDomainProcessSignal);
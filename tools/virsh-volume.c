@@ -384,6 +384,10 @@ static const vshCmdOptDef opts_vol_create[] = {
      .type = VSH_OT_BOOL,
      .help = N_("validate the XML against the schema")
     },
+    {.name = "background",
+     .type = VSH_OT_BOOL,
+     .help = N_("return immediately and build the volume in the background")
+    },
     {.name = NULL}
 };
 
@@ -402,6 +406,9 @@ cmdVolCreate(vshControl *ctl, const vshCmd *cmd)
     if (vshCommandOptBool(cmd, "validate"))
         flags |= VIR_STORAGE_VOL_CREATE_VALIDATE;
 
+    if (vshCommandOptBool(cmd, "background"))
+        flags |= VIR_STORAGE_VOL_CREATE_BACKGROUND;
+
     if (!(pool = virshCommandOptPool(ctl, cmd, "pool", NULL)))
         return false;
 
@@ -457,6 +464,10 @@ static const vshCmdOptDef opts_vol_create_from[] = {
      .type = VSH_OT_BOOL,
      .help = N_("validate the XML against the schema")
     },
+    {.name = "background",
+     .type = VSH_OT_BOOL,
+     .help = N_("return immediately and build the volume in the background")
+    },
     {.name = NULL}
 };
 
@@ -482,6 +493,9 @@ cmdVolCreateFrom(vshControl *ctl, const vshCmd *cmd)
     if (vshCommandOptBool(cmd, "validate"))
         flags |= VIR_STORAGE_VOL_CREATE_VALIDATE;
 
+    if (vshCommandOptBool(cmd, "background"))
+        flags |= VIR_STORAGE_VOL_CREATE_BACKGROUND;
+
     if (vshCommandOptStringReq(ctl, cmd, "file", &from) < 0)
         return false;
 
@@ -557,6 +571,10 @@ static const vshCmdOptDef opts_vol_clone[] = {
      .type = VSH_OT_BOOL,
      .help = N_("print XML document rather than clone the volume")
     },
+    {.name = "background",
+     .type = VSH_OT_BOOL,
+     .help = N_("return immediately and build the volume in the background")
+    },
     {.name = NULL}
 };
 
@@ -580,6 +598,9 @@ cmdVolClone(vshControl *ctl, const vshCmd *cmd)
     if (vshCommandOptBool(cmd, "reflink"))
         flags |= VIR_STORAGE_VOL_CREATE_REFLINK;
 
+    if (vshCommandOptBool(cmd, "background"))
+        flags |= VIR_STORAGE_VOL_CREATE_BACKGROUND;
+
     origpool = virStoragePoolLookupByVolume(origvol);
     if (!origpool) {
         vshError(ctl, "%s", _("failed to get parent pool"));